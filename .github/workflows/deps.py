@@ -54,7 +54,6 @@ def _packages_to_install(args: argparse.Namespace) -> Set[str]:
         "bison",
         "flex",
         "liblua5.4-dev",
-        "libsqlite3-dev",
         "libz-dev",
         "pkg-config",
         "ccache",
@@ -165,11 +165,6 @@ static inline double pow(int x, double y) { return std::pow((double)x, y); }
     // share the same savedir.
     #define VERSIONED_CACHE_DIR
 
-    // Update (text) database files safely; when a Crawl process
-    // starts up and notices that a db file is out-of-date, it updates
-    // it in-place, instead of torching the old file.
-    #define DGL_REWRITE_PROTECT_DB_FILES
-
     // Startup preferences are saved by player name rather than uid,
     // since all players use the same uid in dgamelaunch.
     #ifndef DGL_NO_STARTUP_PREFS_BY_NAME
@@ -293,10 +288,6 @@ static inline double pow(int x, double y) { return std::pow((double)x, y); }
 // these -- usually this means you should place them in ~/.crawl/
 // unless it's a DGL build.
 
-#if !defined(DB_NDBM) && !defined(DB_DBH) && !defined(USE_SQLITE_DBM)
-#define USE_SQLITE_DBM
-#endif
-
 // And now headers we want precompiled
 #ifdef TARGET_COMPILER_VC
 # include "msvc.h"
@@ -46,6 +46,7 @@
 #include "mon-transit.h"
 #include "notes.h"
 #include "output.h" // redraw_screens
+#include "profiler.h"
 #include "religion.h"
 #include "spl-clouds.h" // big_cloud
 #include "stash.h"
@@ -1142,8 +1143,21 @@ const static RiverLayout rivers(1800, baseLayout);
 // This one is not fixed: [0] is a level pulled from the current game
 static vector<const ProceduralLayout*> complex_vec(2);
 
+// Samples computed ahead of time by _abyss_presample(), by grid position,
+// as indices into abyss_presamples (or -1).
+static vector<ProceduralSample> abyss_presamples;
+static FixedArray<int, GXM, GYM> abyss_presample_index(-1);
+
 static ProceduralSample _abyss_grid(const coord_def &p)
 {
+    const int presampled = abyss_presample_index(p);
+    if (presampled >= 0)
+    {
+        const ProceduralSample sample = abyss_presamples[presampled];
+        abyss_sample_queue.push(sample);
+        return sample;
+    }
+
     const coord_def pt = p + abyssal_state.major_coord;
 
     if (_in_wastes(pt))
@@ -1174,6 +1188,57 @@ static ProceduralSample _abyss_grid(const coord_def &p)
     return sample;
 }
 
+/**
+ * Evaluate the abyss layout for a batch of grid positions in one go, so that
+ * _abyss_grid() can pick the results up as the terrain is updated. Sampling
+ * is a pure function of position and depth, so the results are exactly what
+ * _abyss_grid() would have computed; positions that end up not being used
+ * just cost some wasted work, and ones not presampled are sampled as usual.
+ *
+ * Positions that need the full abyss layout are only batched once it has
+ * been set up, since setting it up has side effects that must happen at the
+ * same point as always.
+ */
+static void _abyss_presample(const vector<coord_def> &ps)
+{
+    PROF_SCOPE(PROF_PHASE, "abyss presample");
+    vector<coord_def> wastes_pts, layout_pts;
+    vector<coord_def> wastes_ps, layout_ps;
+    for (const coord_def &p : ps)
+    {
+        const coord_def pt = p + abyssal_state.major_coord;
+        if (_in_wastes(pt))
+        {
+            wastes_pts.push_back(pt);
+            wastes_ps.push_back(p);
+        }
+        else if (abyssLayout)
+        {
+            layout_pts.push_back(pt);
+            layout_ps.push_back(p);
+        }
+    }
+
+    abyss_presamples.clear();
+    wastes.sample_all(wastes_pts, abyssal_state.depth, abyss_presamples);
+    if (!layout_pts.empty())
+        abyssLayout->sample_all(layout_pts, abyssal_state.depth,
+                                abyss_presamples);
+
+    for (size_t i = 0; i < wastes_ps.size(); ++i)
+        abyss_presample_index(wastes_ps[i]) = i;
+    for (size_t i = 0; i < layout_ps.size(); ++i)
+        abyss_presample_index(layout_ps[i]) = wastes_ps.size() + i;
+    profiler::count(PROF_COUNTER, "abyss cells presampled",
+                    abyss_presamples.size());
+}
+
+static void _abyss_clear_presamples()
+{
+    abyss_presamples.clear();
+    abyss_presample_index.init(-1);
+}
+
 static cloud_type _cloud_from_feat(const dungeon_feature_type &ft)
 {
     switch (ft)
@@ -1343,13 +1408,42 @@ static void _abyss_apply_terrain(const map_bitmask &abyss_genlevel_mask,
     if (morph && !abyss_sample_queue.empty())
     {
         used_queue = true;
+        // Take everything that is due off the queue first, so that it can be
+        // resampled as a batch. Resampling only queues samples that change
+        // at the current depth or later, so nothing new becomes due.
+        vector<coord_def> due;
         while (!abyss_sample_queue.empty()
             && abyss_sample_queue.top().changepoint() < abyssal_state.depth)
         {
-            coord_def p = abyss_sample_queue.top().coord();
-            _update_abyss_terrain(p, abyss_genlevel_mask, morph);
+            due.push_back(abyss_sample_queue.top().coord());
             abyss_sample_queue.pop();
         }
+
+        vector<coord_def> batch;
+        for (const coord_def &p : due)
+        {
+            const coord_def rp = p - abyssal_state.major_coord;
+            if (in_bounds(rp))
+                batch.push_back(rp);
+        }
+        _abyss_presample(batch);
+        for (const coord_def &p : due)
+            _update_abyss_terrain(p, abyss_genlevel_mask, morph);
+        _abyss_clear_presamples();
+    }
+    else
+    {
+        vector<coord_def> batch;
+        for (rectangle_iterator ri(MAPGEN_BORDER); ri; ++ri)
+        {
+            if (!map_masked(*ri, MMT_TURNED_TO_FLOOR)
+                && abyss_genlevel_mask(*ri)
+                && (morph || env.grid(*ri) == DNGN_UNSEEN))
+            {
+                batch.push_back(*ri);
+            }
+        }
+        _abyss_presample(batch);
     }
 
     int ii = 0;
@@ -1391,6 +1485,7 @@ static void _abyss_apply_terrain(const map_bitmask &abyss_genlevel_mask,
                                    DNGN_ABYSSAL_STAIR,
                                    abyss_genlevel_mask);
     }
+    _abyss_clear_presamples();
     if (ii)
         dprf(DIAG_ABYSS, "Nuked %d features", ii);
     _ensure_player_habitable(false);
@@ -5,6 +5,16 @@
 #include "env.h"
 #include "losglobal.h"
 
+// The next slot after i that might hold a monster, or max + 1 if there are
+// none up to max.
+static int _next_monster_slot(int i, int max)
+{
+    auto next = upper_bound(env.mon_slots.begin(), env.mon_slots.end(), i);
+    if (next == env.mon_slots.end() || *next > max)
+        return max + 1;
+    return *next;
+}
+
 actor_near_iterator::actor_near_iterator(coord_def c, los_type los)
     : center(c), _los(los), viewer(nullptr),
       include_known_invis(false), i(-1), max(env.max_mon_index)
@@ -67,7 +77,7 @@ bool actor_near_iterator::valid(const actor* a) const
 void actor_near_iterator::advance()
 {
     do
-         if (++i > max)
+         if ((i = _next_monster_slot(i, max)) > max)
              return;
     while (!valid(**this));
 }
@@ -160,7 +170,7 @@ bool monster_near_iterator::valid(const monster* a) const
 void monster_near_iterator::advance()
 {
     do
-         if (++i > max)
+         if ((i = _next_monster_slot(i, max)) > max)
              return;
     while (!valid(**this));
 }
@@ -168,10 +178,9 @@ void monster_near_iterator::advance()
 //////////////////////////////////////////////////////////////////////////
 
 monster_iterator::monster_iterator()
-    : i(0), max(env.max_mon_index)
+    : i(-1), max(env.max_mon_index)
 {
-    while (i <= max && !env.mons[i].alive())
-        i++;
+    advance();
 }
 
 monster_iterator::operator bool() const
@@ -208,7 +217,7 @@ monster_iterator monster_iterator::operator++(int)
 void monster_iterator::advance()
 {
     do
-         if (++i > max)
+         if ((i = _next_monster_slot(i, max)) > max)
              return;
     while (!(*this)->alive());
 }
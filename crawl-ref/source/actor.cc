@@ -9,6 +9,7 @@
 #include "areas.h"
 #include "art-enum.h"
 #include "attack.h"
+#include "beam.h"
 #include "chardump.h"
 #include "delay.h"
 #include "directn.h"
@@ -144,6 +145,7 @@ void actor::set_position(const coord_def &c)
 {
     const coord_def oldpos = position;
     position = c;
+    clear_tracer_cache();
     los_actor_moved(this, oldpos);
     areas_actor_moved(this);
 }
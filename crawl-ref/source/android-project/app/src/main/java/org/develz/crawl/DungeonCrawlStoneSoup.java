@@ -16,7 +16,6 @@ public class DungeonCrawlStoneSoup extends SDLActivity {
                 "mikmod",
                 "smpeg2",
                 "SDL2_mixer",
-                "sqlite",
                 "lua",
                 "zlib",
                 "main"
@@ -8,7 +8,6 @@ SDL_PATH := ../SDL2
 CRAWL_PATH := ../../..
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/$(SDL_PATH)/include \
-                    $(LOCAL_PATH)/../sqlite \
                     $(LOCAL_PATH)/../lua/src \
                     $(LOCAL_PATH)/../freetype/include \
                     $(LOCAL_PATH)/$(CRAWL_PATH) \
@@ -33,6 +32,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/beam.cc \
     $(CRAWL_PATH)/behold.cc \
     $(CRAWL_PATH)/bitary.cc \
+    $(CRAWL_PATH)/blobdb.cc \
     $(CRAWL_PATH)/branch.cc \
     $(CRAWL_PATH)/branch-data-json.cc \
     $(CRAWL_PATH)/bloodspatter.cc \
@@ -50,6 +50,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/crash.cc \
     $(CRAWL_PATH)/ctest.cc \
     $(CRAWL_PATH)/dactions.cc \
+    $(CRAWL_PATH)/data-image.cc \
     $(CRAWL_PATH)/database.cc \
     $(CRAWL_PATH)/dbg-asrt.cc \
     $(CRAWL_PATH)/dbg-maps.cc \
@@ -161,6 +162,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/maps.cc \
     $(CRAWL_PATH)/maybe-bool.cc \
     $(CRAWL_PATH)/melee-attack.cc \
+    $(CRAWL_PATH)/mem-usage.cc \
     $(CRAWL_PATH)/menu.cc \
     $(CRAWL_PATH)/message-stream.cc \
     $(CRAWL_PATH)/message.cc \
@@ -219,6 +221,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/player.cc \
     $(CRAWL_PATH)/potion.cc \
     $(CRAWL_PATH)/precision-menu.cc \
+    $(CRAWL_PATH)/profiler.cc \
     $(CRAWL_PATH)/prompt.cc \
     $(CRAWL_PATH)/quiver.cc \
     $(CRAWL_PATH)/randbook.cc \
@@ -227,6 +230,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/ranged-attack.cc \
     $(CRAWL_PATH)/ray.cc \
     $(CRAWL_PATH)/religion.cc \
+    $(CRAWL_PATH)/replay.cc \
     $(CRAWL_PATH)/scroller.cc \
     $(CRAWL_PATH)/shopping.cc \
     $(CRAWL_PATH)/shout.cc \
@@ -251,7 +255,6 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/spl-vortex.cc \
     $(CRAWL_PATH)/spl-zap.cc \
     $(CRAWL_PATH)/sprint.cc \
-    $(CRAWL_PATH)/sqldbm.cc \
     $(CRAWL_PATH)/stairs.cc \
     $(CRAWL_PATH)/startup.cc \
     $(CRAWL_PATH)/stash.cc \
@@ -336,7 +339,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/rltiles/tiledef-unrand.cc \
     $(CRAWL_PATH)/version.cc
 
-LOCAL_SHARED_LIBRARIES := SDL2 SDL2_image mikmod smpeg2 SDL2_mixer freetype sqlite lua zlib
+LOCAL_SHARED_LIBRARIES := SDL2 SDL2_image mikmod smpeg2 SDL2_mixer freetype lua zlib
 
 LOCAL_LDLIBS := -ldl -lGLESv1_CM -lGLESv2 -llog -landroid
 
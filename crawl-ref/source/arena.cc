@@ -7,7 +7,12 @@
 
 #include "arena.h"
 
+#include <cinttypes>
 #include <stdexcept>
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
 
 #include "act-iter.h"
 #include "colour.h"
@@ -18,6 +23,8 @@
 #include "item-name.h"
 #include "item-status-flag-type.h"
 #include "items.h"
+#include "json.h"
+#include "json-wrapper.h"
 #include "libutil.h"
 #include "los.h"
 #include "macro.h"
@@ -31,6 +38,7 @@
 #include "newgame-def.h"
 #include "ng-init.h"
 #include "prompt.h"
+#include "random.h"
 #include "spl-miscast.h"
 #include "state.h"
 #include "stringutil.h"
@@ -222,6 +230,10 @@ namespace arena
     static level_id place(BRANCH_DEPTHS, 1);
     static string arena_log;
 
+    // What each faction (a, then b) has done in the current fight.
+    static int damage_dealt[2];
+    static int spells_cast[2];
+
     static void adjust_spells(monster* mons, bool no_summons, bool no_animate)
     {
         monster_spells &spells(mons->spells);
@@ -823,55 +835,10 @@ namespace arena
         is_respawning = false;
     }
 
-    static void do_fight()
+    // Count a finished fight, and work out who won it. Returns whether
+    // it was a tie.
+    static bool settle_outcome()
     {
-        viewwindow();
-        update_screen();
-        clear_messages(true);
-
-        {
-            cursor_control coff(false);
-            while (fight_is_on() && !contest_cancelled)
-            {
-#ifdef ARENA_VERBOSE
-                mprf("---- Turn #%d ----", turns);
-#endif
-
-                if (crawl_state.terminal_resized)
-                    show_fight_banner();
-
-                // Check the consistency of our book-keeping every 100 turns.
-                if ((turns++ % 100) == 0)
-                    count_foes();
-
-                you.time_taken = 10;
-                //report_foes();
-                world_reacts();
-                do_miscasts();
-                do_respawn(faction_a);
-                do_respawn(faction_b);
-                balance_spawners();
-                if (!contest_cancelled)
-                    ui::delay(Options.view_delay);
-                clear_messages();
-                ASSERT(you.pet_target == MHITNOT);
-            }
-            if (!contest_cancelled)
-            {
-                viewwindow();
-                update_screen();
-            }
-        }
-
-        if (contest_cancelled)
-        {
-            mpr("Cancelling contest at user request");
-            clear_messages();
-            return;
-        }
-
-        clear_messages();
-
         trials_done++;
 
         // We bother with all this to properly deal with ties, and with
@@ -924,6 +891,60 @@ namespace arena
         else if (faction_a.won)
             team_a_wins++;
 
+        return was_tied;
+    }
+
+    static void do_fight()
+    {
+        viewwindow();
+        update_screen();
+        clear_messages(true);
+
+        {
+            cursor_control coff(false);
+            while (fight_is_on() && !contest_cancelled)
+            {
+#ifdef ARENA_VERBOSE
+                mprf("---- Turn #%d ----", turns);
+#endif
+
+                if (crawl_state.terminal_resized)
+                    show_fight_banner();
+
+                // Check the consistency of our book-keeping every 100 turns.
+                if ((turns++ % 100) == 0)
+                    count_foes();
+
+                you.time_taken = 10;
+                //report_foes();
+                world_reacts();
+                do_miscasts();
+                do_respawn(faction_a);
+                do_respawn(faction_b);
+                balance_spawners();
+                if (!contest_cancelled)
+                    ui::delay(Options.view_delay);
+                clear_messages();
+                ASSERT(you.pet_target == MHITNOT);
+            }
+            if (!contest_cancelled)
+            {
+                viewwindow();
+                update_screen();
+            }
+        }
+
+        if (contest_cancelled)
+        {
+            mpr("Cancelling contest at user request");
+            clear_messages();
+            return;
+        }
+
+        clear_messages();
+
+        const bool was_tied = settle_outcome();
+
         show_fight_banner(true);
 
         string msg;
@@ -1086,6 +1107,312 @@ namespace arena
 
         write_results();
     }
+
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+    string batch_file;
+    int batch_jobs = 1;
+
+    // Batch fights still going after this many turns are called off.
+    static const int BATCH_TURN_LIMIT = 10000;
+
+    struct batch_matchup
+    {
+        string spec;
+        int runs;
+    };
+
+    // Totals over all the fights of one matchup.
+    struct batch_summary
+    {
+        int fights = 0;
+        int a_wins = 0;
+        int b_wins = 0;
+        int ties = 0;
+        int timeouts = 0;
+        int errors = 0;
+        int64_t turns = 0;
+        int64_t damage[2] = { 0, 0 };
+        int64_t spells[2] = { 0, 0 };
+    };
+
+    // Each line of the batch file is an arena spec, as for -arena, with an
+    // optional runs:N tag for the number of times to fight it. Blank lines
+    // and lines starting with # are skipped.
+    /// @throws arena_error if the file can't be read or a count is bad.
+    static vector<batch_matchup> read_batch_file()
+    {
+        FileLineInput input(batch_file.c_str());
+        if (input.error())
+        {
+            throw arena_error_f("Can't read arena batch file \"%s\"",
+                                batch_file.c_str());
+        }
+
+        vector<batch_matchup> matchups;
+        while (!input.eof())
+        {
+            string line = trimmed_string(input.get_line());
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            int runs = strip_number_tag(line, "runs:");
+            if (runs == TAG_UNFOUND)
+                runs = 1;
+            else if (runs < 1)
+                throw arena_error_f("Bad runs: tag in \"%s\"", line.c_str());
+            matchups.push_back({ trimmed_string(line), runs });
+        }
+        return matchups;
+    }
+
+    static uint64_t fight_seed(uint64_t base_seed, int fight)
+    {
+        return base_seed + fight * 0x9e3779b97f4a7c15ULL;
+    }
+
+    static JsonNode *faction_pair(int64_t a, int64_t b)
+    {
+        JsonNode *pair = json_mkobject();
+        json_append_member(pair, "a", json_mknumber(a));
+        json_append_member(pair, "b", json_mknumber(b));
+        return pair;
+    }
+
+    // Run one fight without drawing anything, and describe how it went.
+    static JsonNode *batch_fight(const batch_matchup &matchup, int matchup_idx,
+                                 int fight, uint64_t seed)
+    {
+        JsonNode *result = json_mkobject();
+        json_append_member(result, "fight", json_mknumber(fight));
+        json_append_member(result, "matchup", json_mknumber(matchup_idx));
+        json_append_member(result, "spec", json_mkstring(matchup.spec));
+        json_append_member(result, "seed",
+                           json_mkstring(make_stringf("%" PRIu64, seed)));
+
+        rng::seed(seed);
+        memset(damage_dealt, 0, sizeof(damage_dealt));
+        memset(spells_cast, 0, sizeof(spells_cast));
+        try
+        {
+            global_setup(matchup.spec);
+            setup_fight();
+        }
+        catch (const arena_error &error)
+        {
+            json_append_member(result, "error", json_mkstring(error.what()));
+            return result;
+        }
+
+        while (turns < BATCH_TURN_LIMIT && fight_is_on())
+        {
+            // Check the consistency of our book-keeping every 100 turns.
+            if ((turns++ % 100) == 0)
+                count_foes();
+
+            you.time_taken = 10;
+            world_reacts();
+            do_miscasts();
+            do_respawn(faction_a);
+            do_respawn(faction_b);
+            balance_spawners();
+            clear_messages();
+        }
+
+        const char *winner;
+        if (faction_a.active_members > 0 && faction_b.active_members > 0)
+            winner = "none";
+        else if (settle_outcome())
+            winner = "tie";
+        else
+            winner = faction_a.won ? "a" : "b";
+
+        json_append_member(result, "winner", json_mkstring(winner));
+        json_append_member(result, "turns", json_mknumber(turns));
+        json_append_member(result, "damage",
+                           faction_pair(damage_dealt[0], damage_dealt[1]));
+        json_append_member(result, "spells",
+                           faction_pair(spells_cast[0], spells_cast[1]));
+        return result;
+    }
+
+    // Run every jobs'th fight, starting from the given one, writing one
+    // JSON line for each to out.
+    static void run_batch_worker(const vector<batch_matchup> &matchups,
+                                 const vector<int> &fight_matchups,
+                                 int first, int jobs, uint64_t base_seed,
+                                 const string &out)
+    {
+        FILE *f = fopen_u(out.c_str(), "w");
+        if (!f)
+            return;
+
+        msg::suppress quiet;
+        for (int fight = first; fight < (int) fight_matchups.size();
+             fight += jobs)
+        {
+            const int m = fight_matchups[fight];
+            JsonWrapper result(batch_fight(matchups[m], m, fight,
+                                           fight_seed(base_seed, fight)));
+            fprintf(f, "%s\n", result.to_string().c_str());
+            fflush(f);
+        }
+        fclose(f);
+    }
+
+    static void add_to_summary(batch_summary &sum, const JsonNode *result)
+    {
+        sum.fights++;
+        if (json_find_member(result, "error"))
+        {
+            sum.errors++;
+            return;
+        }
+
+        const string winner = json_find_member(result, "winner")->string_;
+        if (winner == "a")
+            sum.a_wins++;
+        else if (winner == "b")
+            sum.b_wins++;
+        else if (winner == "tie")
+            sum.ties++;
+        else
+            sum.timeouts++;
+
+        sum.turns += json_find_member(result, "turns")->number_;
+        const char *sides[2] = { "a", "b" };
+        for (int i = 0; i < 2; i++)
+        {
+            sum.damage[i] += json_find_member(
+                json_find_member(result, "damage"), sides[i])->number_;
+            sum.spells[i] += json_find_member(
+                json_find_member(result, "spells"), sides[i])->number_;
+        }
+    }
+
+    static string batch_summary_table(const vector<batch_matchup> &matchups,
+                                      const vector<batch_summary> &sums)
+    {
+        string table = make_stringf("%-32s %6s %6s %6s %5s %5s %5s %7s %8s"
+                                    " %8s %7s %7s\n",
+                                    "Matchup", "Fights", "A wins", "B wins",
+                                    "Ties", "Limit", "Error", "Turns",
+                                    "A damage", "B damage", "A casts",
+                                    "B casts");
+        for (size_t m = 0; m < matchups.size(); m++)
+        {
+            const batch_summary &sum = sums[m];
+            const int done = max(1, sum.fights - sum.errors);
+            table += make_stringf("%-32s %6d %6d %6d %5d %5d %5d %7.1f %8.1f"
+                                  " %8.1f %7.1f %7.1f\n",
+                                  chop_string(matchups[m].spec, 32).c_str(),
+                                  sum.fights, sum.a_wins, sum.b_wins,
+                                  sum.ties, sum.timeouts, sum.errors,
+                                  double(sum.turns) / done,
+                                  double(sum.damage[0]) / done,
+                                  double(sum.damage[1]) / done,
+                                  double(sum.spells[0]) / done,
+                                  double(sum.spells[1]) / done);
+        }
+        return table;
+    }
+
+    // Run every fight in the batch file, spread across batch_jobs forked
+    // workers, each fight with its own seed. The workers' results are
+    // gathered in fight order into arena-batch.jsonl, and summed up by
+    // matchup in arena-batch.result.
+    NORETURN static void run_batch()
+    {
+        vector<batch_matchup> matchups;
+        try
+        {
+            matchups = read_batch_file();
+        }
+        catch (const arena_error &error)
+        {
+            end(1, false, "%s", error.what());
+        }
+
+        vector<int> fight_matchups;
+        for (size_t m = 0; m < matchups.size(); m++)
+            for (int run = 0; run < matchups[m].runs; run++)
+                fight_matchups.push_back(m);
+        if (fight_matchups.empty())
+            end(1, false, "No matchups in \"%s\"", batch_file.c_str());
+
+        const int jobs = min(batch_jobs, (int) fight_matchups.size());
+        const uint64_t base_seed = Options.seed ? Options.seed
+                                                : rng::get_uint64();
+        Options.use_animations = UA_NONE;
+        Options.view_delay = 0;
+
+        vector<pid_t> workers;
+        vector<string> outputs;
+        for (int job = 0; job < jobs; job++)
+        {
+            outputs.push_back(make_stringf("arena-batch.jsonl.%d", job));
+            const pid_t pid = fork();
+            if (pid < 0)
+                end(1, true, "Couldn't start arena worker %d", job);
+            if (pid == 0)
+            {
+                run_batch_worker(matchups, fight_matchups, job, jobs,
+                                 base_seed, outputs.back());
+                // Don't run any of the game's exit handlers in a worker.
+                _exit(0);
+            }
+            workers.push_back(pid);
+        }
+
+        for (int job = 0; job < jobs; job++)
+        {
+            int status;
+            if (waitpid(workers[job], &status, 0) < 0
+                || !WIFEXITED(status) || WEXITSTATUS(status))
+            {
+                fprintf(stderr, "Arena worker %d failed; its remaining "
+                                "fights are missing.\n", job);
+            }
+        }
+
+        map<int, string> lines;
+        vector<batch_summary> sums(matchups.size());
+        for (const string &output : outputs)
+        {
+            FileLineInput input(output.c_str());
+            while (!input.error() && !input.eof())
+            {
+                const string line = input.get_line();
+                if (line.empty())
+                    continue;
+                JsonWrapper result(json_decode(line.c_str()));
+                if (!result.node)
+                    continue;
+                const int fight = json_find_member(result.node,
+                                                   "fight")->number_;
+                add_to_summary(sums[fight_matchups[fight]], result.node);
+                lines[fight] = line;
+            }
+            unlink_u(output.c_str());
+        }
+
+        FILE *jsonl = fopen_u("arena-batch.jsonl", "w");
+        if (!jsonl)
+            end(1, true, "Couldn't write arena-batch.jsonl");
+        for (const auto &line : lines)
+            fprintf(jsonl, "%s\n", line.second.c_str());
+        fclose(jsonl);
+
+        const string table = batch_summary_table(matchups, sums);
+        FILE *result = fopen_u("arena-batch.result", "w");
+        if (!result)
+            end(1, true, "Couldn't write arena-batch.result");
+        fprintf(result, "%s", table.c_str());
+        fclose(result);
+        fprintf(stdout, "%s", table.c_str());
+
+        end(0);
+    }
+#endif
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -1250,6 +1577,30 @@ void arena_split_monster(monster* split_from, monster* split_to)
     arena::to_respawn[split_to->mindex()] = member_idx;
 }
 
+void arena_monster_hurt(const monster* mons, const actor* agent, int amount)
+{
+    // Only count what one side did to the other: not friendly fire, nor
+    // damage from neutrals or from nothing in particular.
+    const monster* attacker = agent ? agent->as_monster() : nullptr;
+    if (!attacker)
+        return;
+    if (attacker->attitude == ATT_FRIENDLY && mons->attitude == ATT_HOSTILE)
+        arena::damage_dealt[0] += amount;
+    else if (attacker->attitude == ATT_HOSTILE
+             && mons->attitude == ATT_FRIENDLY)
+    {
+        arena::damage_dealt[1] += amount;
+    }
+}
+
+void arena_monster_cast(const monster* mons)
+{
+    if (mons->attitude == ATT_FRIENDLY)
+        arena::spells_cast[0]++;
+    else if (mons->attitude == ATT_HOSTILE)
+        arena::spells_cast[1]++;
+}
+
 void arena_monster_died(monster* mons, killer_type killer,
                         int killer_index, bool silent, const item_def* corpse)
 {
@@ -1511,6 +1862,17 @@ NORETURN void run_arena(const newgame_def& choice, const string &default_arena_t
 {
     ASSERT(crawl_state.game_is_arena());
 
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+    if (!arena::batch_file.empty())
+    {
+        _init_arena();
+#ifdef WIZARD
+        you.wizard = true;
+#endif
+        arena::run_batch();
+    }
+#endif
+
     newgame_def arena_choice = choice;
     string last_teams = default_arena_teams;
     if (arena::file != nullptr)
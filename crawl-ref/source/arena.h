@@ -15,6 +15,18 @@ struct coord_def;
 
 struct newgame_def;
 
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+namespace arena
+{
+    // Set by -arena-batch: a file of matchups to run headless, one per
+    // line, in place of an interactive arena.
+    extern string batch_file;
+    // Set by -arena-jobs: the number of processes to run them in, from 1
+    // to 64.
+    extern int batch_jobs;
+}
+#endif
+
 NORETURN void run_arena(const newgame_def& choice, const string &default_arena_teams);
 
 monster_type arena_pick_random_monster(const level_id &place);
@@ -31,4 +43,8 @@ void arena_split_monster(monster* split_from, monster* split_to);
 void arena_monster_died(monster* mons, killer_type killer,
                         int killer_index, bool silent, const item_def* corpse);
 
+void arena_monster_hurt(const monster* mons, const actor* agent, int amount);
+
+void arena_monster_cast(const monster* mons);
+
 int arena_cull_items();
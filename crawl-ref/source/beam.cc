@@ -58,6 +58,7 @@
 #include "options.h"
 #include "player-stats.h"
 #include "potion.h"
+#include "profiler.h"
 #include "prompt.h"
 #include "ranged-attack.h"
 #include "religion.h"
@@ -2123,6 +2124,110 @@ int silver_damages_victim(actor* victim, int damage, string &dmg_msg)
     return ret;
 }
 
+// Monsters frequently trace the same beam more than once in a single action:
+// once while deciding whether a spell is worth casting, and again when
+// actually casting it. Remember the outcome of recent monster tracers so the
+// repeats are free. Only the inputs that can change a tracer's result are
+// part of the key; anything that isn't (monster attitudes, enchantments and
+// the like) is handled by emptying the cache at the start of every monster
+// action and whenever actors move, die or change enchantments, or terrain
+// changes.
+struct tracer_cache_key
+{
+    mid_t source_id;
+    coord_def source;
+    coord_def target;
+    int range;
+    beam_type flavour;
+    spell_type origin_spell;
+    string name;
+    int dam_num, dam_size;
+    int ench_power, hit;
+    int ex_size;
+    int foe_ratio;
+    killer_type thrower;
+    bool pierce, is_explosion, aimed_at_spot, affects_nothing;
+    bool stop_at_allies, safe_to_user;
+    bool explode_only, explosion_hole;
+
+    tracer_cache_key(const bolt &b, bool explode, bool hole)
+        : source_id(b.source_id), source(b.source), target(b.target),
+          range(b.range), flavour(b.flavour), origin_spell(b.origin_spell),
+          name(b.name), dam_num(b.damage.num), dam_size(b.damage.size),
+          ench_power(b.ench_power), hit(b.hit), ex_size(b.ex_size),
+          foe_ratio(b.foe_ratio), thrower(b.thrower), pierce(b.pierce),
+          is_explosion(b.is_explosion), aimed_at_spot(b.aimed_at_spot),
+          affects_nothing(b.affects_nothing),
+          stop_at_allies(b.stop_at_allies), safe_to_user(b.safe_to_user),
+          explode_only(explode), explosion_hole(hole)
+    {
+    }
+
+    bool operator<(const tracer_cache_key &o) const
+    {
+        return tie(source_id, source, target, range, flavour, origin_spell,
+                   name, dam_num, dam_size, ench_power, hit, ex_size,
+                   foe_ratio, thrower, pierce, is_explosion, aimed_at_spot,
+                   affects_nothing, stop_at_allies, safe_to_user,
+                   explode_only, explosion_hole)
+               < tie(o.source_id, o.source, o.target, o.range, o.flavour,
+                     o.origin_spell, o.name, o.dam_num, o.dam_size,
+                     o.ench_power, o.hit, o.ex_size, o.foe_ratio, o.thrower,
+                     o.pierce, o.is_explosion, o.aimed_at_spot,
+                     o.affects_nothing, o.stop_at_allies, o.safe_to_user,
+                     o.explode_only, o.explosion_hole);
+    }
+};
+
+// What a tracer leaves behind in the tracer object and the bolt.
+struct tracer_cache_entry
+{
+    targeting_tracer tracer;
+    bolt result;
+};
+
+static map<tracer_cache_key, tracer_cache_entry> tracer_cache;
+
+void clear_tracer_cache()
+{
+    tracer_cache.clear();
+}
+
+// Chaos and random beams roll their flavour as they go, and beams with
+// special explosions or ranged attacks attached carry more state than the
+// key describes.
+static bool _tracer_is_cacheable(const bolt &pbolt)
+{
+    return pbolt.real_flavour != BEAM_CHAOS
+           && pbolt.real_flavour != BEAM_RANDOM
+           && !pbolt.special_explosion
+           && !pbolt.ranged_atk
+           && !pbolt.chose_ray;
+}
+
+static void _copy_tracer_output(const bolt &from, bolt &to)
+{
+    to.flavour            = from.flavour;
+    to.real_flavour       = from.real_flavour;
+    to.affects_nothing    = from.affects_nothing;
+    to.stop_at_allies     = from.stop_at_allies;
+    to.seen               = from.seen;
+    to.heard              = from.heard;
+    to.path_taken         = from.path_taken;
+    to.extra_range_used   = from.extra_range_used;
+    to.aimed_at_feet      = from.aimed_at_feet;
+    to.passed_target      = from.passed_target;
+    to.in_explosion_phase = from.in_explosion_phase;
+    to.friendly_past_target = from.friendly_past_target;
+    to.bounces            = from.bounces;
+    to.bounce_pos         = from.bounce_pos;
+    to.last_affected_actor_pos = from.last_affected_actor_pos;
+    to.reflections        = from.reflections;
+    to.reflector          = from.reflector;
+    to.use_target_as_pos  = from.use_target_as_pos;
+    to.ray                = from.ray;
+}
+
 //  Used by monsters in "planning" which spell to cast. Fires off a "tracer"
 //  which tells the monster what it'll hit if it breathes/casts etc.
 //
@@ -2166,11 +2271,36 @@ void fire_tracer(const monster* mons, targeting_tracer& tracer,
     if (pbolt.origin_spell == SPELL_FIRE_STORM)
         pbolt.ex_size = 3;
 
-    // Fire!
-    if (explode_only)
-        pbolt.explode(tracer, false, explosion_hole);
-    else
-        pbolt.fire(tracer);
+    profiler::count(PROF_COUNTER, "tracer calls");
+
+    const bool cacheable = _tracer_is_cacheable(pbolt);
+    const tracer_cache_key key(pbolt, explode_only, explosion_hole);
+    if (cacheable)
+    {
+        auto cached = tracer_cache.find(key);
+        if (cached != tracer_cache.end())
+        {
+            profiler::count(PROF_COUNTER, "tracer cache hits");
+            tracer = cached->second.tracer;
+            _copy_tracer_output(cached->second.result, pbolt);
+            return;
+        }
+    }
+
+    {
+        PROF_SCOPE(PROF_SPELL_TRACER, pbolt.origin_spell != SPELL_NO_SPELL
+                                      ? spell_title(pbolt.origin_spell)
+                                      : "(non-spell beam)");
+
+        // Fire!
+        if (explode_only)
+            pbolt.explode(tracer, false, explosion_hole);
+        else
+            pbolt.fire(tracer);
+    }
+
+    if (cacheable)
+        tracer_cache.emplace(key, tracer_cache_entry{tracer, pbolt});
 }
 
 set<coord_def> create_feat_splash(coord_def center,
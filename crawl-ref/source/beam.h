@@ -473,6 +473,7 @@ int silver_damages_victim(actor* victim, int damage, string &dmg_msg);
 void fire_tracer(const monster* mons, targeting_tracer& tracer,
                  bolt &pbolt, bool explode_only = false,
                  bool explosion_hole = false);
+void clear_tracer_cache();
 spret zapping(zap_type ztype, int power, bolt &pbolt,
                    bool needs_tracer = false, const char* msg = nullptr,
                    bool fail = false);
@@ -0,0 +1,299 @@
+/**
+ * @file
+ * @brief Read-only, memory-mapped key/value files for the text databases.
+**/
+
+#include "AppHdr.h"
+
+#include "blobdb.h"
+
+#include <cstring>
+#include <fcntl.h>
+#ifdef UNIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "files.h"
+#include "hash.h"
+#include "syscalls.h"
+
+static const char BLOB_MAGIC[4] = { 'C', 'T', 'D', 'B' };
+// Bump this whenever the layout changes; older files are then rebuilt.
+static const uint32_t BLOB_VERSION = 1;
+
+// At most half full, so that probes stay short.
+static uint32_t _index_size(size_t entries)
+{
+    uint32_t size = 16;
+    while (size < entries * 2)
+        size *= 2;
+    return size;
+}
+
+bool write_blob_db(const string &file, const vector<blob_db_record> &records)
+{
+    blob_header header;
+    memcpy(header.magic, BLOB_MAGIC, sizeof(header.magic));
+    header.version = BLOB_VERSION;
+    header.entry_count = records.size();
+    header.index_size = _index_size(records.size());
+
+    string strings;
+    const auto add_string = [&strings](const string &s)
+    {
+        const uint32_t offset = strings.size();
+        strings += s;
+        return offset;
+    };
+
+    vector<blob_entry> entries;
+    vector<blob_alternative> alts;
+    for (const blob_db_record &record : records)
+    {
+        blob_entry entry;
+        entry.hash = hash32(record.key.data(), record.key.size());
+        entry.key_offset = add_string(record.key);
+        entry.key_length = record.key.size();
+        entry.value_offset = add_string(record.value);
+        entry.value_length = record.value.size();
+        entry.first_alternative = alts.size();
+        entry.alternative_count = record.alternatives.size();
+        entry.total_weight = record.alternatives.empty()
+                             ? 0 : record.alternatives.back().second;
+        for (const auto &alt : record.alternatives)
+        {
+            alts.push_back({ add_string(alt.first),
+                             (uint32_t) alt.first.size(),
+                             (uint32_t) alt.second });
+        }
+        entries.push_back(entry);
+    }
+    header.alternative_count = alts.size();
+    header.string_size = strings.size();
+
+    vector<uint32_t> index(header.index_size, 0);
+    const uint32_t mask = header.index_size - 1;
+    for (uint32_t i = 0; i < entries.size(); i++)
+    {
+        // A repeated key replaces the earlier record, as it would in a DBM.
+        uint32_t slot = entries[i].hash & mask;
+        while (index[slot] && records[index[slot] - 1].key != records[i].key)
+            slot = (slot + 1) & mask;
+        index[slot] = i + 1;
+    }
+
+    // Write a new file and move it into place, rather than rewriting one
+    // that other processes may have mapped.
+    const string tmp = file + ".tmp";
+    FILE *f = fopen_u(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+              && fwrite(index.data(), sizeof(uint32_t), index.size(), f)
+                 == index.size()
+              && fwrite(entries.data(), sizeof(blob_entry), entries.size(), f)
+                 == entries.size()
+              && fwrite(alts.data(), sizeof(blob_alternative), alts.size(), f)
+                 == alts.size()
+              && fwrite(strings.data(), 1, strings.size(), f)
+                 == strings.size();
+    ok = !fclose(f) && ok;
+    if (ok)
+        ok = !rename_u(tmp.c_str(), file.c_str());
+    if (!ok)
+        unlink_u(tmp.c_str());
+    return ok;
+}
+
+BlobDB::BlobDB()
+    : data(nullptr), data_size(0), mapped(false), header(nullptr),
+      index(nullptr), entries(nullptr), alts(nullptr), strings(nullptr)
+{
+}
+
+BlobDB::~BlobDB()
+{
+    close();
+}
+
+bool BlobDB::open(const string &file)
+{
+    close();
+
+#ifdef UNIX
+    const int fd = open_u(file.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) || !st.st_size)
+    {
+        ::close(fd);
+        return false;
+    }
+    // Read-only shared mappings of the same file share their pages, however
+    // many games have it open.
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return false;
+    data = static_cast<const char *>(map);
+    data_size = st.st_size;
+    mapped = true;
+#else
+    FILE *f = fopen_u(file.c_str(), "rb");
+    if (!f)
+        return false;
+    buffer.resize(file_size(f));
+    const bool read_ok = !buffer.empty()
+                         && fread(buffer.data(), 1, buffer.size(), f)
+                            == buffer.size();
+    fclose(f);
+    if (!read_ok)
+    {
+        buffer.clear();
+        return false;
+    }
+    data = buffer.data();
+    data_size = buffer.size();
+#endif
+
+    header = reinterpret_cast<const blob_header *>(data);
+    if (data_size < sizeof(blob_header)
+        || memcmp(header->magic, BLOB_MAGIC, sizeof(header->magic))
+        || header->version != BLOB_VERSION
+        || !header->index_size
+        || (header->index_size & (header->index_size - 1))
+        || header->index_size <= header->entry_count)
+    {
+        close();
+        return false;
+    }
+
+    const uint64_t expected_size = sizeof(blob_header)
+        + (uint64_t) header->index_size * sizeof(uint32_t)
+        + (uint64_t) header->entry_count * sizeof(blob_entry)
+        + (uint64_t) header->alternative_count * sizeof(blob_alternative)
+        + header->string_size;
+    if (expected_size != data_size)
+    {
+        close();
+        return false;
+    }
+
+    index = reinterpret_cast<const uint32_t *>(data + sizeof(blob_header));
+    entries = reinterpret_cast<const blob_entry *>(index + header->index_size);
+    alts = reinterpret_cast<const blob_alternative *>(
+        entries + header->entry_count);
+    strings = reinterpret_cast<const char *>(alts + header->alternative_count);
+
+    // A truncated or garbled file gets rebuilt rather than read past.
+    for (uint32_t i = 0; i < header->entry_count; i++)
+    {
+        const blob_entry &e = entries[i];
+        if ((uint64_t) e.key_offset + e.key_length > header->string_size
+            || (uint64_t) e.value_offset + e.value_length > header->string_size
+            || (uint64_t) e.first_alternative + e.alternative_count
+               > header->alternative_count)
+        {
+            close();
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < header->alternative_count; i++)
+    {
+        if ((uint64_t) alts[i].text_offset + alts[i].text_length
+            > header->string_size)
+        {
+            close();
+            return false;
+        }
+    }
+    // Lookups stop at an empty slot, so there must be some; repeated keys
+    // leave fewer slots used than there are entries.
+    uint32_t used_slots = 0;
+    for (uint32_t i = 0; i < header->index_size; i++)
+    {
+        if (index[i] > header->entry_count)
+        {
+            close();
+            return false;
+        }
+        used_slots += !!index[i];
+    }
+    if (used_slots > header->entry_count)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void BlobDB::close()
+{
+#ifdef UNIX
+    if (mapped && data)
+        munmap(const_cast<char *>(data), data_size);
+#endif
+    buffer.clear();
+    data = nullptr;
+    data_size = 0;
+    mapped = false;
+    header = nullptr;
+    index = nullptr;
+    entries = nullptr;
+    alts = nullptr;
+    strings = nullptr;
+}
+
+const blob_entry *BlobDB::find(const string &key) const
+{
+    if (!data)
+        return nullptr;
+
+    const uint32_t hash = hash32(key.data(), key.size());
+    const uint32_t mask = header->index_size - 1;
+    for (uint32_t slot = hash & mask; index[slot]; slot = (slot + 1) & mask)
+    {
+        const blob_entry &e = entries[index[slot] - 1];
+        if (e.hash == hash && e.key_length == key.size()
+            && !memcmp(strings + e.key_offset, key.data(), key.size()))
+        {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+uint32_t BlobDB::size() const
+{
+    return data ? header->entry_count : 0;
+}
+
+const blob_entry &BlobDB::entry(uint32_t i) const
+{
+    ASSERT(i < size());
+    return entries[i];
+}
+
+string BlobDB::key(const blob_entry &e) const
+{
+    return string(strings + e.key_offset, e.key_length);
+}
+
+string BlobDB::value(const blob_entry &e) const
+{
+    return string(strings + e.value_offset, e.value_length);
+}
+
+const blob_alternative *BlobDB::alternatives(const blob_entry &e) const
+{
+    return alts + e.first_alternative;
+}
+
+string BlobDB::text(const blob_alternative &alt) const
+{
+    return string(strings + alt.text_offset, alt.text_length);
+}
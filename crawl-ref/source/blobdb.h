@@ -0,0 +1,105 @@
+/**
+ * @file
+ * @brief Read-only, memory-mapped key/value files for the text databases.
+**/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::pair;
+using std::string;
+using std::vector;
+
+// The on-disk layout, all in native byte order: a blob_header, the hash
+// index (index_size slots, each an entry number plus one, or 0 if empty),
+// the entries, the alternatives, and then the string data that they all
+// point into.
+struct blob_header
+{
+    char     magic[4];
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t index_size;
+    uint32_t alternative_count;
+    uint32_t string_size;
+};
+
+struct blob_entry
+{
+    uint32_t hash;
+    uint32_t key_offset;
+    uint32_t key_length;
+    uint32_t value_offset;
+    uint32_t value_length;
+    // The value split into its weighted alternatives, as
+    // _chooseStrByWeight() in database.cc would split it; no alternatives
+    // if it couldn't be.
+    uint32_t first_alternative;
+    uint32_t alternative_count;
+    uint32_t total_weight;
+};
+
+struct blob_alternative
+{
+    uint32_t text_offset;
+    uint32_t text_length;
+    // The total weight of this and all earlier alternatives.
+    uint32_t weight;
+};
+
+struct blob_db_record
+{
+    string key;
+    string value;
+    // Each alternative's text and cumulative weight.
+    vector<pair<string, int>> alternatives;
+};
+
+// Write the records to file, replacing it atomically, so that processes
+// that have the old file mapped keep reading the old contents. If a key is
+// repeated, find() gets its last record. Returns false if the file couldn't
+// be written.
+bool write_blob_db(const string &file, const vector<blob_db_record> &records);
+
+class BlobDB
+{
+public:
+    BlobDB();
+    ~BlobDB();
+    BlobDB(const BlobDB&) = delete;
+    BlobDB &operator=(const BlobDB&) = delete;
+
+    // Map the file, checking that it's a complete blob of the current
+    // version. Returns false (leaving the BlobDB closed) if it isn't.
+    bool open(const string &file);
+    void close();
+    bool is_open() const { return data != nullptr; }
+
+    // The entry for key, or nullptr if there isn't one.
+    const blob_entry *find(const string &key) const;
+
+    // Entries, in the order they were written.
+    uint32_t size() const;
+    const blob_entry &entry(uint32_t i) const;
+
+    string key(const blob_entry &e) const;
+    string value(const blob_entry &e) const;
+    const blob_alternative *alternatives(const blob_entry &e) const;
+    string text(const blob_alternative &alt) const;
+
+private:
+    const char *data;
+    size_t data_size;
+    bool mapped;
+    vector<char> buffer; // the contents, where files can't be mapped
+
+    const blob_header *header;
+    const uint32_t *index;
+    const blob_entry *entries;
+    const blob_alternative *alts;
+    const char *strings;
+};
@@ -0,0 +1,66 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "act-iter.h"
+#include "env.h"
+#include "mon-act.h"
+#include "mon-place.h"
+#include "mon-util.h"
+
+// Every live monster, by scanning all of env.mons.
+static vector<int> _live_by_scan()
+{
+    vector<int> live;
+    for (int i = 0; i < MAX_MONSTERS; ++i)
+        if (env.mons[i].alive())
+            live.push_back(i);
+    return live;
+}
+
+static vector<int> _live_by_iterator()
+{
+    vector<int> live;
+    for (monster_iterator mi; mi; ++mi)
+        live.push_back(mi->mindex());
+    return live;
+}
+
+TEST_CASE("monster_iterator visits exactly the live monsters in order",
+          "[single-file]")
+{
+    init_monsters();
+    reset_all_monsters();
+    env.max_mon_index = 0;
+    REQUIRE(_live_by_iterator().empty());
+
+    vector<monster*> placed;
+    for (int n = 0; n < 10; ++n)
+    {
+        monster *mons = get_free_monster();
+        REQUIRE(mons);
+        mons->type = MONS_RAT;
+        mons->hit_points = 1;
+        placed.push_back(mons);
+    }
+    REQUIRE(_live_by_iterator() == _live_by_scan());
+
+    // A dead monster that hasn't been cleaned up yet is skipped; an empty
+    // slot is dropped from the list at the end of the turn and reused.
+    placed[3]->hit_points = 0;
+    placed[6]->reset();
+    REQUIRE(_live_by_iterator() == _live_by_scan());
+
+    clear_monster_flags();
+    REQUIRE(env.max_mon_index == placed[9]->mindex());
+    REQUIRE(_live_by_iterator() == _live_by_scan());
+
+    monster *reused = get_free_monster();
+    REQUIRE(reused == placed[6]);
+    reused->type = MONS_RAT;
+    reused->hit_points = 1;
+    REQUIRE(_live_by_iterator() == _live_by_scan());
+
+    reset_all_monsters();
+    REQUIRE(_live_by_iterator().empty());
+}
@@ -0,0 +1,146 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "coord.h"
+#include "coordit.h"
+#include "env.h"
+#include "ghost.h"
+#include "item-name.h"
+#include "item-prop.h"
+#include "items.h"
+#include "los.h"
+#include "los-def.h"
+#include "mon-pathfind.h"
+#include "stringutil.h"
+#include "tags.h"
+
+// Benchmarks for hot paths, hidden from the normal test run. Use
+// "make catch2-benchmarks", or pass "[benchmark]" to the test executable, to
+// run them. Each one sets up its own map, so they don't depend on order.
+
+// An open level, with a broken wall across the middle.
+static void _build_benchmark_level()
+{
+    for (rectangle_iterator ri(0); ri; ++ri)
+        env.grid(*ri) = in_bounds(*ri) ? DNGN_FLOOR : DNGN_PERMAROCK_WALL;
+
+    for (int y = 10; y < GYM - 10; y++)
+    {
+        if (y % 7)
+            env.grid(coord_def(GXM / 2, y)) = DNGN_ROCK_WALL;
+    }
+    los_changed();
+}
+
+TEST_CASE("Line of sight benchmarks", "[.][benchmark]")
+{
+    _build_benchmark_level();
+    const coord_def centre(GXM / 2 - 3, GYM / 2);
+
+    BENCHMARK("los_def update")
+    {
+        los_def los(centre);
+        los.update();
+        return los.see_cell(centre + coord_def(6, 1));
+    };
+
+    BENCHMARK("cell_see_cell_nocache across a view")
+    {
+        int seen = 0;
+        for (radius_iterator ri(centre, LOS_DEFAULT_RANGE, C_SQUARE); ri; ++ri)
+            seen += cell_see_cell_nocache(centre, *ri);
+        return seen;
+    };
+}
+
+TEST_CASE("Pathfinding benchmarks", "[.][benchmark]")
+{
+    _build_benchmark_level();
+    const coord_def start(5, GYM / 2);
+    const coord_def target(GXM - 6, GYM / 2 + 1);
+
+    BENCHMARK("monster_pathfind across the level")
+    {
+        monster_pathfind mp;
+        mp.init_pathfind(start, target);
+        return mp.backtrack().size();
+    };
+}
+
+TEST_CASE("Marshalling benchmarks", "[.][benchmark]")
+{
+    vector<ghost_demon> ghosts(MAX_GHOSTS);
+    for (size_t i = 0; i < ghosts.size(); i++)
+        ghosts[i].name = make_stringf("ghost%d", (int) i);
+
+    vector<unsigned char> buf;
+    {
+        writer w(&buf);
+        tag_write_ghosts(w, ghosts);
+    }
+
+    BENCHMARK("write a ghost tag")
+    {
+        vector<unsigned char> out;
+        writer w(&out);
+        tag_write_ghosts(w, ghosts);
+        return out.size();
+    };
+
+    BENCHMARK("read a ghost tag")
+    {
+        reader r(buf, TAG_MINOR_VERSION);
+        return tag_read_ghosts(r).size();
+    };
+
+    BENCHMARK("marshall and unmarshall shorts")
+    {
+        vector<unsigned char> out;
+        writer w(&out);
+        for (int i = 0; i < 10000; i++)
+            marshallShort(w, i);
+        reader r(out);
+        int total = 0;
+        for (int i = 0; i < 10000; i++)
+            total += unmarshallShort(r);
+        return total;
+    };
+}
+
+TEST_CASE("Item naming benchmarks", "[.][benchmark]")
+{
+    vector<item_def> items;
+    for (const object_class_type base_type : { OBJ_WEAPONS, OBJ_ARMOUR,
+                                               OBJ_POTIONS, OBJ_SCROLLS,
+                                               OBJ_WANDS })
+    {
+        for (const auto sub_type : all_item_subtypes(base_type))
+        {
+            item_def item;
+            item.base_type = base_type;
+            item.sub_type = sub_type;
+            item.quantity = 1;
+            items.push_back(item);
+        }
+    }
+
+    BENCHMARK("name every weapon, armour, potion, scroll and wand")
+    {
+        size_t length = 0;
+        for (const item_def &item : items)
+            length += item.name(DESC_A).size();
+        return length;
+    };
+
+    BENCHMARK("look up item kinds by name")
+    {
+        int found = 0;
+        for (const item_def &item : items)
+        {
+            found += item_kind_by_name(item.name(DESC_DBNAME, true, true))
+                         .base_type != OBJ_UNASSIGNED;
+        }
+        return found;
+    };
+}
@@ -0,0 +1,148 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include <cstdio>
+
+#include "blobdb.h"
+#include "database.h"
+#include "stringutil.h"
+
+static blob_db_record _record(const string &key, const string &value)
+{
+    blob_db_record record = { key, value, {} };
+    _split_weighted_string(record.value, record.alternatives);
+    return record;
+}
+
+static vector<string> _alternatives(const BlobDB &db, const blob_entry &e)
+{
+    vector<string> texts;
+    const blob_alternative *alts = db.alternatives(e);
+    for (uint32_t i = 0; i < e.alternative_count; i++)
+        texts.push_back(db.text(alts[i]));
+    return texts;
+}
+
+TEST_CASE("Weighted entries are split into their alternatives",
+          "[single-file]")
+{
+    vector<pair<string, int>> parts;
+
+    SECTION("Unweighted alternatives weigh 10 each")
+    {
+        REQUIRE_FALSE(_split_weighted_string("\n\none\n\n\ntwo\nlines\n\n",
+                                             parts));
+        REQUIRE(parts == vector<pair<string, int>>{ { "one", 10 },
+                                                    { "two\nlines", 20 } });
+    }
+
+    SECTION("Weights add up")
+    {
+        REQUIRE_FALSE(_split_weighted_string("w:5\nrare\n\ncommon\n\n"
+                                             "w:85\nvery common", parts));
+        REQUIRE(parts == vector<pair<string, int>>{ { "rare", 5 },
+                                                    { "common", 15 },
+                                                    { "very common", 100 } });
+    }
+
+    SECTION("Malformed entries have no alternatives")
+    {
+        for (const string entry : { "", "\n\n", "text\n\nw:5", "w:0\nnever" })
+        {
+            CAPTURE(entry);
+            parts = { { "stale", 1 } };
+            REQUIRE(_split_weighted_string(entry, parts));
+            REQUIRE(parts.empty());
+        }
+    }
+}
+
+TEST_CASE("Blob databases can be written and read back", "[single-file]")
+{
+    const string filename = "test_blobdb.blob";
+
+    vector<blob_db_record> records;
+    for (int i = 0; i < 100; i++)
+        records.push_back(_record(make_stringf("key %d", i),
+                                  make_stringf("value %d", i)));
+    records.push_back(_record("weighted", "w:1\nfirst\n\nw:2\nsecond"));
+    records.push_back(_record("unsplittable", "w:3"));
+    records.push_back(_record("key 7", "replaced"));
+    REQUIRE(write_blob_db(filename, records));
+
+    BlobDB db;
+    REQUIRE(db.open(filename));
+    REQUIRE(db.size() == records.size());
+    REQUIRE(db.key(db.entry(0)) == "key 0");
+
+    SECTION("Every key is found")
+    {
+        for (int i = 0; i < 100; i++)
+        {
+            if (i == 7)
+                continue;
+            CAPTURE(i);
+            const blob_entry *e = db.find(make_stringf("key %d", i));
+            REQUIRE(e);
+            REQUIRE(db.value(*e) == make_stringf("value %d", i));
+            REQUIRE(_alternatives(db, *e)
+                    == vector<string>{ make_stringf("value %d", i) });
+            REQUIRE(e->total_weight == 10);
+        }
+        REQUIRE_FALSE(db.find("key 100"));
+        REQUIRE_FALSE(db.find(""));
+    }
+
+    SECTION("A repeated key gets its last record")
+    {
+        const blob_entry *e = db.find("key 7");
+        REQUIRE(e);
+        REQUIRE(db.value(*e) == "replaced");
+    }
+
+    SECTION("Alternatives keep their cumulative weights")
+    {
+        const blob_entry *e = db.find("weighted");
+        REQUIRE(e);
+        REQUIRE(_alternatives(db, *e) == vector<string>{ "first", "second" });
+        REQUIRE(db.alternatives(*e)[0].weight == 1);
+        REQUIRE(db.alternatives(*e)[1].weight == 3);
+        REQUIRE(e->total_weight == 3);
+    }
+
+    SECTION("Entries that can't be split keep their value")
+    {
+        const blob_entry *e = db.find("unsplittable");
+        REQUIRE(e);
+        REQUIRE(db.value(*e) == "w:3");
+        REQUIRE(e->alternative_count == 0);
+        REQUIRE(e->total_weight == 0);
+    }
+
+    SECTION("A truncated file is rejected")
+    {
+        db.close();
+        string contents;
+        {
+            FILE *f = fopen(filename.c_str(), "rb");
+            REQUIRE(f);
+            char buf[4096];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+                contents.append(buf, n);
+            fclose(f);
+        }
+        FILE *f = fopen(filename.c_str(), "wb");
+        REQUIRE(f);
+        fwrite(contents.data(), 1, contents.size() - 1, f);
+        fclose(f);
+
+        REQUIRE_FALSE(db.open(filename));
+        REQUIRE_FALSE(db.is_open());
+        REQUIRE_FALSE(db.find("key 0"));
+    }
+
+    db.close();
+    remove(filename.c_str());
+}
@@ -0,0 +1,59 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "coordit.h"
+#include "dgn-proclayouts.h"
+
+static void _check_batch_matches(const ProceduralLayout &layout,
+                                 const coord_def &origin, uint32_t offset)
+{
+    vector<coord_def> ps;
+    for (rectangle_iterator ri(0); ri; ++ri)
+        ps.push_back(*ri + origin);
+
+    vector<ProceduralSample> batch;
+    layout.sample_all(ps, offset, batch);
+    REQUIRE(batch.size() == ps.size());
+
+    for (size_t i = 0; i < ps.size(); ++i)
+    {
+        const ProceduralSample single = layout(ps[i], offset);
+        INFO("Sampling at " << ps[i].x << ", " << ps[i].y);
+        REQUIRE(batch[i].coord() == single.coord());
+        REQUIRE(batch[i].feat() == single.feat());
+        REQUIRE(batch[i].changepoint() == single.changepoint());
+    }
+}
+
+TEST_CASE("Batched layout sampling matches per-cell sampling",
+          "[single-file]")
+{
+    // The same nesting of layouts as the abyss uses, minus the level layout.
+    const DiamondLayout diamond30(3,0);
+    const DiamondLayout diamond21(2,1);
+    const ColumnLayout column2(2);
+    const ColumnLayout column26(2,6);
+    const WorleyLayout worleyL(123456,
+                               { &diamond30, &diamond21, &column2, &column26 });
+    const RoilingChaosLayout chaosA(8675309, 450);
+    const RoilingChaosLayout chaosB(7654321, 400);
+    const NewAbyssLayout newAbyssLayout(7629);
+    const WorleyLayout mixed(4321,
+                             { &chaosA, &worleyL, &chaosB, &newAbyssLayout });
+    const WorleyLayout base(314159, { &newAbyssLayout, &mixed }, 5.0);
+    const RiverLayout rivers(1800, base);
+    const WastesLayout wastes;
+
+    const coord_def origins[] = { coord_def(0, 0),
+                                  coord_def(0x12345678, 0x2345678),
+                                  coord_def(-5000, 700) };
+    for (const coord_def &origin : origins)
+    {
+        for (uint32_t offset : { 0u, 123456u, 0x7FFFFFFu })
+        {
+            _check_batch_matches(rivers, origin, offset);
+            _check_batch_matches(wastes, origin, offset);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include "hiscores.h"
+#include "initfile.h"
+#include "stringutil.h"
+#include "unwind.h"
+
+static string _score_line(int score, const string &name)
+{
+    return make_stringf("v=0.1:name=%s:sc=%d\n", name.c_str(), score);
+}
+
+static vector<int> _scores_in(const string &filename)
+{
+    vector<int> scores;
+    ifstream in(filename);
+    string line;
+    while (getline(in, line))
+    {
+        scorefile_entry se;
+        REQUIRE(se.parse(line + "\n"));
+        scores.push_back(se.get_score());
+    }
+    return scores;
+}
+
+static int _add_score(int score, const string &name)
+{
+    scorefile_entry se;
+    se.parse(_score_line(score, name));
+    return hiscores_new_entry(se);
+}
+
+TEST_CASE("New high scores are inserted in order", "[single-file]")
+{
+    const string filename = "test_hiscores.scores";
+    unwind_var<string> scorefile(SysEnv.scorefile, filename);
+    {
+        FILE *f = fopen(filename.c_str(), "w");
+        REQUIRE(f);
+        for (int score : { 500, 400, 300, 200, 100 })
+            fputs(_score_line(score, "old").c_str(), f);
+        fclose(f);
+    }
+
+    SECTION("in the middle")
+    {
+        REQUIRE(_add_score(350, "new") == 2);
+        REQUIRE(_scores_in(filename)
+                == vector<int>{ 500, 400, 350, 300, 200, 100 });
+    }
+
+    SECTION("ahead of a tie")
+    {
+        REQUIRE(_add_score(300, "new") == 2);
+        REQUIRE(_scores_in(filename)
+                == vector<int>{ 500, 400, 300, 300, 200, 100 });
+    }
+
+    SECTION("at the top and the bottom")
+    {
+        REQUIRE(_add_score(900, "new") == 0);
+        REQUIRE(_add_score(1, "new") == 6);
+        REQUIRE(_scores_in(filename)
+                == vector<int>{ 900, 500, 400, 300, 200, 100, 1 });
+    }
+
+    SECTION("after a last line with no newline")
+    {
+        FILE *f = fopen(filename.c_str(), "a");
+        REQUIRE(f);
+        string last = _score_line(50, "old");
+        last.pop_back();
+        fputs(last.c_str(), f);
+        fclose(f);
+
+        REQUIRE(_add_score(10, "new") == 6);
+        REQUIRE(_scores_in(filename)
+                == vector<int>{ 500, 400, 300, 200, 100, 50, 10 });
+    }
+
+    SECTION("not at all when the file is full")
+    {
+        // Ties go ahead of existing entries.
+        for (int i = 5; i < SCORE_FILE_ENTRIES; i++)
+            REQUIRE(_add_score(50, "filler") == 5);
+        REQUIRE(_add_score(10, "new") == -1);
+        REQUIRE(_add_score(60, "new") == 5);
+
+        const vector<int> scores = _scores_in(filename);
+        REQUIRE(scores.size() == SCORE_FILE_ENTRIES);
+        REQUIRE(scores[5] == 60);
+        REQUIRE(scores.back() == 50);
+    }
+
+    remove(filename.c_str());
+}
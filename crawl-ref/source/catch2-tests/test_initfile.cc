@@ -0,0 +1,55 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "options.h"
+
+TEST_CASE( "Option lines are split into key, subkey and value",
+           "[single-file]" ) {
+    game_options opts;
+
+    SECTION ("Lines without an equals sign are ignored") {
+        REQUIRE( !opts.parse_option_line("just some text").valid );
+    }
+
+    SECTION ("Keys are trimmed and lowercased; values keep their case") {
+        const opt_parse_state state
+            = opts.parse_option_line("  Show_More  =  Yes Please ");
+        REQUIRE( state.valid );
+        REQUIRE( state.key == "show_more" );
+        REQUIRE( state.subkey.empty() );
+        REQUIRE( state.raw_field == "Yes Please" );
+        REQUIRE( state.field == "yes please" );
+        REQUIRE( state.line_type == RCFILE_LINE_EQUALS );
+    }
+
+    SECTION ("Operators before the equals sign are recognised") {
+        REQUIRE( opts.parse_option_line("a += b").plus_equal() );
+        REQUIRE( opts.parse_option_line("a+=b").plus_equal() );
+        REQUIRE( opts.parse_option_line("a ^= b").caret_equal() );
+        REQUIRE( opts.parse_option_line("a -= b").minus_equal() );
+        REQUIRE( opts.parse_option_line("a -= b").key == "a" );
+    }
+
+    SECTION ("A dot separates the subkey, but not in the value") {
+        const opt_parse_state state
+            = opts.parse_option_line("Menu.Colour = a.b");
+        REQUIRE( state.key == "menu" );
+        REQUIRE( state.subkey == "colour" );
+        REQUIRE( state.field == "a.b" );
+    }
+
+    SECTION ("Aliases are defined with := and then followed") {
+        const opt_parse_state alias = opts.parse_option_line("ae := b");
+        REQUIRE( alias.valid );
+        REQUIRE( alias.line_type == RCFILE_LINE_DIRECTIVE );
+        REQUIRE( opts.parse_option_line("ae += x").key == "b" );
+    }
+
+    SECTION ("An empty key is allowed through") {
+        const opt_parse_state state = opts.parse_option_line("  = x");
+        REQUIRE( state.valid );
+        REQUIRE( state.key.empty() );
+        REQUIRE( state.field == "x" );
+    }
+}
@@ -0,0 +1,74 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "item-name.h"
+#include "feature.h"
+#include "item-prop.h"
+#include "items.h"
+#include "showsymb.h"
+#include "stringutil.h"
+#include "terrain.h"
+#include "viewchar.h"
+
+TEST_CASE("Lazily built item name cache round-trips item names",
+          "[single-file]")
+{
+    for (int i = 0; i < NUM_OBJECT_CLASSES; i++)
+    {
+        const object_class_type base_type = static_cast<object_class_type>(i);
+        if (base_type == OBJ_BOOKS || base_type == OBJ_JEWELLERY)
+            continue; // manuals and the ring/amulet gap need special handling
+
+        for (const auto sub_type : all_item_subtypes(base_type))
+        {
+            item_def item;
+            item.base_type = base_type;
+            item.sub_type = sub_type;
+            const string name = item.name(base_type == OBJ_RUNES
+                                              ? DESC_PLAIN : DESC_DBNAME,
+                                          true, true);
+            if (name.find("buggy") != string::npos)
+                continue;
+
+            INFO("Looking up '" << name << "'");
+            const item_kind kind = item_kind_by_name(name);
+            REQUIRE(kind.base_type == base_type);
+            // Several subtypes can share a name; the first one wins.
+            const item_kind again = item_kind_by_name(uppercase_string(name));
+            REQUIRE(again.base_type == kind.base_type);
+            REQUIRE(again.sub_type == kind.sub_type);
+        }
+    }
+
+    REQUIRE(item_kind_by_name("no such item").base_type == OBJ_UNASSIGNED);
+}
+
+TEST_CASE("Item glyph index is rebuilt identically", "[single-file]")
+{
+    init_char_table(CSET_ASCII);
+    init_show_table();
+
+    const item_def potion = [] {
+        item_def item;
+        item.base_type = OBJ_POTIONS;
+        item.sub_type = POT_CURING;
+        return item;
+    }();
+    const char32_t glyph = get_item_glyph(potion).ch;
+
+    init_item_name_cache();
+    const vector<string> first = item_name_list_for_glyph(glyph);
+    REQUIRE(!first.empty());
+
+    init_item_name_cache();
+    REQUIRE(item_name_list_for_glyph(glyph) == first);
+}
+
+TEST_CASE("Feature descriptions are found without explicit initialisation",
+          "[single-file]")
+{
+    REQUIRE(feat_by_desc("a granite statue") == DNGN_GRANITE_STATUE);
+    REQUIRE(feat_by_desc("A Granite Statue") == DNGN_GRANITE_STATUE);
+    REQUIRE(feat_by_desc("no such feature") == DNGN_UNSEEN);
+}
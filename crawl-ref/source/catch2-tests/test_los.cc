@@ -0,0 +1,254 @@
+#include <cstdio>
+#include <random>
+
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "coordit.h"
+#include "data-image.h"
+#include "los.h"
+#include "ray.h"
+
+static const coord_def CENTRE(40, 35);
+
+// Opacities drawn at random around CENTRE.
+class random_opacity : public opacity_func
+{
+public:
+    random_opacity(unsigned int seed)
+    {
+        mt19937 rng(seed);
+        uniform_int_distribution<int> percent(0, 99);
+        const int opaque = 5 + seed % 4 * 10;
+        const int half = seed % 3 * 5;
+        for (int x = -LOS_MAX_RANGE; x <= LOS_MAX_RANGE; ++x)
+            for (int y = -LOS_MAX_RANGE; y <= LOS_MAX_RANGE; ++y)
+            {
+                const int roll = percent(rng);
+                cells(coord_def(x, y)) = roll < opaque ? OPC_OPAQUE
+                                       : roll < opaque + half ? OPC_HALF
+                                                              : OPC_CLEAR;
+            }
+    }
+
+    CLONE(random_opacity)
+
+    opacity_type operator()(const coord_def &p) const override
+    {
+        const coord_def d = p - CENTRE;
+        return d.rdist() <= LOS_MAX_RANGE ? cells(d) : OPC_CLEAR;
+    }
+
+private:
+    SquareArray<opacity_type, LOS_MAX_RANGE> cells;
+};
+
+static int _gcd(int x, int y)
+{
+    return y ? _gcd(y, x % y) : x;
+}
+
+// The first-quadrant footprints (without the origin) of every ray that
+// losight() and find_ray() choose from, cast the same way as the tables
+// are built: the two perpendiculars, then every slope up to
+// 2 * LOS_MAX_RANGE - 2 from every half-step along the origin's edge.
+static const vector<vector<coord_def>> &_reference_rays()
+{
+    static vector<vector<coord_def>> rays;
+    if (!rays.empty())
+        return rays;
+
+    auto cast = [](double x, double y, double dx, double dy)
+    {
+        ray_def ray(geom::ray(x, y, dx, dy));
+        vector<coord_def> cells;
+        while (true)
+        {
+            // Rays through a corner aren't used at all.
+            if (!ray.advance())
+                return;
+            if (ray.pos().rdist() > LOS_MAX_RANGE)
+                break;
+            cells.push_back(ray.pos());
+        }
+        rays.push_back(cells);
+    };
+
+    cast(0.5, 0.5, 0.0, 1.0);
+    cast(0.5, 0.5, 1.0, 0.0);
+    const int max_angle = 2 * LOS_MAX_RANGE - 2;
+    for (int xangle = 1; xangle <= max_angle; ++xangle)
+        for (int yangle = 1; yangle <= max_angle; ++yangle)
+        {
+            if (_gcd(xangle, yangle) != 1)
+                continue;
+            for (int intercept = 1; intercept < 2 * yangle; ++intercept)
+            {
+                const double start = (double) intercept / (2 * yangle);
+                cast(start, 0.5, xangle, yangle);
+                cast(0.5, start, yangle, xangle);
+            }
+        }
+    return rays;
+}
+
+// Brute force: a cell is seen if any ray gets to it with less than
+// OPC_OPAQUE in total in the cells before it.
+static los_grid _reference_los(const coord_def &c, const opacity_func &opc)
+{
+    los_grid seen;
+    seen.init(false);
+    seen(coord_def(0, 0)) = true;
+    for (int sx : { 1, -1 })
+        for (int sy : { 1, -1 })
+            for (const vector<coord_def> &cells : _reference_rays())
+            {
+                int blocked = OPC_CLEAR;
+                for (const coord_def &p : cells)
+                {
+                    if (blocked >= OPC_OPAQUE)
+                        break;
+                    const coord_def q(sx * p.x, sy * p.y);
+                    seen(q) = true;
+                    blocked += opc(c + q);
+                }
+            }
+    return seen;
+}
+
+static const circle_def _full_range(LOS_MAX_RANGE, C_SQUARE);
+
+static void _check_losight(unsigned int seed)
+{
+    const random_opacity opc(seed);
+    const los_grid expected = _reference_los(CENTRE, opc);
+    los_grid seen;
+    losight(seen, CENTRE, opc, _full_range);
+
+    for (rectangle_iterator ri(coord_def(0, 0), LOS_MAX_RANGE); ri; ++ri)
+    {
+        CAPTURE(seed, ri->x, ri->y);
+        REQUIRE(seen(*ri) == expected(*ri));
+    }
+}
+
+TEST_CASE("losight matches a brute force reference", "[single-file]")
+{
+    const auto seed = GENERATE(range(1, 25));
+    _check_losight(seed);
+}
+
+TEST_CASE("find_ray finds clear rays where the reference sees", "[single-file]")
+{
+    const auto seed = GENERATE(range(1, 25));
+    const random_opacity opc(seed);
+    const los_grid expected = _reference_los(CENTRE, opc);
+
+    for (rectangle_iterator ri(coord_def(0, 0), LOS_MAX_RANGE); ri; ++ri)
+    {
+        if (ri->origin())
+            continue;
+        CAPTURE(seed, ri->x, ri->y);
+        const coord_def target = CENTRE + *ri;
+
+        ray_def ray;
+        const bool found = find_ray(CENTRE, target, ray, opc);
+        REQUIRE(found == expected(*ri));
+        if (!found)
+            continue;
+
+        // The ray has to get there through the cells it was checked for.
+        REQUIRE(ray.pos() == CENTRE);
+        int blocked = OPC_CLEAR;
+        while (true)
+        {
+            REQUIRE(ray.advance());
+            REQUIRE((ray.pos() - CENTRE).rdist() <= ri->rdist());
+            if (ray.pos() == target)
+                break;
+            blocked += opc(ray.pos());
+        }
+        REQUIRE(blocked < OPC_OPAQUE);
+    }
+}
+
+static const string IMAGE_FILE = "test_los.img";
+
+static void _remove_image()
+{
+    remove(IMAGE_FILE.c_str());
+    remove((IMAGE_FILE + ".lk").c_str());
+}
+
+TEST_CASE("Data image sections are kept until their layout changes",
+          "[single-file]")
+{
+    _remove_image();
+    data_image::open(IMAGE_FILE);
+
+    int builds = 0;
+    string contents;
+    auto build = [&]()
+    {
+        ++builds;
+        return contents;
+    };
+    auto read = [&](uint32_t layout)
+    {
+        size_t size;
+        const char *data = data_image::section("test", layout, build, &size);
+        return string(data, size);
+    };
+
+    contents = string("first\0section", 13);
+    REQUIRE(read(1) == contents);
+    REQUIRE(builds == 1);
+
+    // Read back from the file rather than built again.
+    const string first = contents;
+    contents = "not this";
+    REQUIRE(read(1) == first);
+    REQUIRE(builds == 1);
+
+    // A new layout replaces the section.
+    contents = "second";
+    REQUIRE(read(2) == "second");
+    REQUIRE(builds == 2);
+    REQUIRE(read(2) == "second");
+    REQUIRE(builds == 2);
+
+    _remove_image();
+}
+
+TEST_CASE("Stale LOS tables in the data image are rebuilt", "[single-file]")
+{
+    _remove_image();
+    data_image::open(IMAGE_FILE);
+
+    // Tables in a layout that LOS_TABLE_LAYOUT never has, and that would
+    // fail the size checks if they were used.
+    int stale_builds = 0;
+    auto stale = [&]()
+    {
+        ++stale_builds;
+        return string(64, '\xff');
+    };
+    size_t size;
+    data_image::section("los", 0, stale, &size);
+    REQUIRE(stale_builds == 1);
+
+    clear_rays_on_exit();
+    _check_losight(1);
+
+    // The rebuilt tables can be read back...
+    clear_rays_on_exit();
+    _check_losight(2);
+
+    // ... and took the stale ones' place.
+    data_image::section("los", 0, stale, &size);
+    REQUIRE(stale_builds == 2);
+
+    clear_rays_on_exit();
+    _remove_image();
+}
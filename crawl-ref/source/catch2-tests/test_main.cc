@@ -1,7 +1,133 @@
-#define CATCH_CONFIG_MAIN
-
 #include "catch_amalgamated.hpp"
 
 #include "AppHdr.h"
 
 #include "fake-main.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#ifndef TARGET_OS_WINDOWS
+# include <sys/wait.h>
+#endif
+
+#include "item-prop.h"
+#include "mon-util.h"
+#include "mutation.h"
+
+// Data that many tests need, and that never changes once loaded. With
+// --jobs, this is loaded once, before forking, and every shard starts from
+// a copy of it.
+static void _init_shared_test_data()
+{
+    init_properties();
+    init_monsters();
+    init_mut_index();
+}
+
+// Whether s is a job count, and if so what it is.
+static bool _parse_jobs(const char *s, int &jobs)
+{
+    if (!*s || strspn(s, "0123456789") != strlen(s))
+        return false;
+    jobs = atoi(s);
+    return true;
+}
+
+// Take "--jobs N", "-j N" or "-jN" out of the arguments, leaving the rest
+// (including anything else starting with -j) for Catch.
+static int _take_jobs_arg(vector<char*> &args)
+{
+    int jobs = 1;
+    for (auto it = args.begin() + 1; it != args.end();)
+    {
+        if ((!strcmp(*it, "--jobs") || !strcmp(*it, "-j"))
+            && it + 1 != args.end() && _parse_jobs(*(it + 1), jobs))
+        {
+            it = args.erase(it, it + 2);
+        }
+        else if (!strncmp(*it, "-j", 2) && _parse_jobs(*it + 2, jobs))
+            it = args.erase(it);
+        else
+            ++it;
+    }
+    return max(jobs, 1);
+}
+
+#ifndef TARGET_OS_WINDOWS
+// Run the tests as `jobs` forked processes, each running one shard of the
+// test cases. Each shard writes its report to a file, so that the reports
+// can be shown in order once they've all finished.
+static int _run_sharded(const vector<char*> &args, int jobs)
+{
+    vector<pid_t> pids;
+    vector<string> reports;
+    fflush(stdout);
+    for (int shard = 0; shard < jobs; shard++)
+    {
+        reports.push_back(make_stringf("catch2-shard-%d-%d.log",
+                                       (int) getpid(), shard));
+        const pid_t pid = fork();
+        if (pid < 0)
+        {
+            fprintf(stderr, "Couldn't fork for test shard %d\n", shard);
+            exit(1);
+        }
+        if (pid == 0)
+        {
+            const string count = to_string(jobs);
+            const string index = to_string(shard);
+            vector<char*> shard_args = args;
+            shard_args.push_back(const_cast<char*>("--shard-count"));
+            shard_args.push_back(const_cast<char*>(count.c_str()));
+            shard_args.push_back(const_cast<char*>("--shard-index"));
+            shard_args.push_back(const_cast<char*>(index.c_str()));
+            shard_args.push_back(const_cast<char*>("--out"));
+            shard_args.push_back(const_cast<char*>(reports.back().c_str()));
+            exit(Catch::Session().run((int) shard_args.size(),
+                                      shard_args.data()));
+        }
+        pids.push_back(pid);
+    }
+
+    int result = 0;
+    for (int shard = 0; shard < jobs; shard++)
+    {
+        int status;
+        if (waitpid(pids[shard], &status, 0) < 0 || !WIFEXITED(status))
+        {
+            fprintf(stderr, "Test shard %d died\n", shard);
+            result = max(result, 1);
+        }
+        else
+            result = max(result, WEXITSTATUS(status));
+
+        if (FILE *report = fopen(reports[shard].c_str(), "r"))
+        {
+            char buf[4096];
+            size_t len;
+            while ((len = fread(buf, 1, sizeof(buf), report)) > 0)
+                fwrite(buf, 1, len, stdout);
+            fclose(report);
+        }
+        unlink(reports[shard].c_str());
+    }
+    return result;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    vector<char*> args(argv, argv + argc);
+    const int jobs = _take_jobs_arg(args);
+
+    _init_shared_test_data();
+
+#ifndef TARGET_OS_WINDOWS
+    if (jobs > 1)
+        return _run_sharded(args, jobs);
+#else
+    UNUSED(jobs);
+#endif
+    return Catch::Session().run((int) args.size(), args.data());
+}
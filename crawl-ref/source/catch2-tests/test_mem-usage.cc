@@ -0,0 +1,63 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "mem-usage.h"
+#include "store.h"
+
+TEST_CASE( "Props memory estimates follow their contents", "[single-file]" ) {
+    CrawlHashTable props;
+    REQUIRE( props.memory_used() == 0 );
+
+    SECTION ("Each value adds to the estimate") {
+        props["count"] = 3;
+        const size_t one = props.memory_used();
+        REQUIRE( one > 0 );
+
+        props["name"] = string(200, 'x');
+        REQUIRE( props.memory_used() >= one + 200 );
+    }
+
+    SECTION ("Nested tables and vectors are counted") {
+        CrawlVector &vec = props["list"].new_vector(SV_INT);
+        const size_t empty = props.memory_used();
+        for (int i = 0; i < 100; i++)
+            vec.push_back(i);
+        REQUIRE( props.memory_used() >= empty + 100 * sizeof(CrawlStoreValue) );
+
+        CrawlHashTable &table = props["table"].new_table();
+        const size_t before = props.memory_used();
+        table["key"] = string(100, 'y');
+        REQUIRE( props.memory_used() >= before + 100 );
+    }
+
+    SECTION ("Erasing a value gives its memory back") {
+        props["count"] = 3;
+        const size_t one = props.memory_used();
+        props["name"] = string(200, 'x');
+        props.erase("name");
+        REQUIRE( props.memory_used() == one );
+    }
+}
+
+TEST_CASE( "Short strings use no heap memory", "[single-file]" ) {
+    REQUIRE( mem_usage::string_bytes("") == 0 );
+    REQUIRE( mem_usage::string_bytes(string(1000, 'z')) >= 1000 );
+}
+
+TEST_CASE( "Strings are counted exactly when they are on the heap",
+           "[single-file]" ) {
+    // 20 characters are more than libstdc++ keeps in the string itself,
+    // though still fewer than sizeof(string).
+    for (size_t len : { (size_t) 20, sizeof(string) - 1, sizeof(string) }) {
+        const string s(len, 'z');
+        const char *start = reinterpret_cast<const char *>(&s);
+        const bool inside = s.data() >= start
+                            && s.data() < start + sizeof(string);
+        CAPTURE( len, inside );
+        if (inside)
+            REQUIRE( mem_usage::string_bytes(s) == 0 );
+        else
+            REQUIRE( mem_usage::string_bytes(s) > len );
+    }
+}
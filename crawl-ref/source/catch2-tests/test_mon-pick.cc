@@ -0,0 +1,77 @@
+#include "catch_amalgamated.hpp"
+
+#include "AppHdr.h"
+
+#include "branch.h"
+#include "mon-pick.h"
+#include "mon-pick-data.h"
+#include "mon-util.h"
+#include "random.h"
+
+// The weighted pick as it was before picks were served from cached tables:
+// scan every entry, veto, compute its rarity, then roll.
+static monster_type _uncached_pick(const vector<pop_entry>& weights,
+                                   int level, mon_pick_vetoer veto)
+{
+    monster_picker picker;
+    vector<pair<monster_type, int>> valid;
+    int totalrar = 0;
+
+    for (const pop_entry& pop : weights)
+    {
+        if (level < pop.minr || level > pop.maxr)
+            continue;
+        if (veto && (invalid_monster_type(pop.value) || veto(pop.value)))
+            continue;
+
+        const int rar = picker.rarity_at(pop, level);
+        valid.emplace_back(pop.value, rar);
+        totalrar += rar;
+    }
+
+    if (valid.empty())
+        return MONS_0;
+
+    totalrar = random2(totalrar);
+    for (const auto &entry : valid)
+        if ((totalrar -= entry.second) < 0)
+            return entry.first;
+
+    return NUM_MONSTERS;
+}
+
+TEST_CASE("Cached monster picks match uncached picks", "[single-file]")
+{
+    init_monsters();
+
+    const mon_pick_vetoer vetoers[] = { nullptr, mons_class_is_stationary };
+    for (branch_iterator it; it; ++it)
+    {
+        for (int depth = 1; depth <= it->numlevels; depth++)
+        {
+            const level_id place(it->id, depth);
+            for (mon_pick_vetoer veto : vetoers)
+            {
+                INFO("Picking for " << place.describe()
+                     << (veto ? " with a vetoer" : ""));
+
+                const uint64_t seed = it->id * 1000 + depth;
+                vector<monster_type> cached, uncached;
+                {
+                    rng::subgenerator subgen(seed);
+                    for (int i = 0; i < 50; i++)
+                        cached.push_back(pick_monster(place, veto));
+                }
+                {
+                    rng::subgenerator subgen(seed);
+                    for (int i = 0; i < 50; i++)
+                    {
+                        uncached.push_back(
+                            _uncached_pick(population[it->id], depth, veto));
+                    }
+                }
+                REQUIRE(cached == uncached);
+            }
+        }
+    }
+}
@@ -4,8 +4,10 @@
 
 #include "AppHdr.h"
 
+#include "ghost.h"
 #include "map-cell.h"
 #include "random.h"
+#include "stringutil.h"
 #include "tags.h"
 
 TEST_CASE( "Vehumet gifts can be decoded", "[single-file]" ) {
@@ -245,3 +247,41 @@ TEST_CASE( "Basic marshalling/unmarshalling works correctly.", "[single-file]" )
         }
     }
 }
+
+TEST_CASE( "Ghosts can be sampled from a ghost tag", "[single-file]" ) {
+
+    vector<ghost_demon> ghosts(5);
+    for (size_t i = 0; i < ghosts.size(); i++)
+    {
+        ghosts[i].name = make_stringf("ghost%d", (int) i);
+        // Vary the record lengths, so that skipping has to read through them.
+        ghosts[i].title = string(i * 3, 'x');
+        ghosts[i].xl = i + 1;
+    }
+
+    vector<unsigned char> buf;
+    auto w = writer(&buf);
+    tag_write_ghosts(w, ghosts);
+
+    SECTION ("the ghost count can be read alone") {
+        auto r = reader(buf, TAG_MINOR_VERSION);
+        REQUIRE(tag_read_ghost_count(r) == 5);
+    }
+
+    SECTION ("sampled ghosts match the stored ghosts") {
+        rng::subgenerator subgen(0, 0);
+        set<string> seen;
+        for (int i = 0; i < 100; i++)
+        {
+            auto r = reader(buf, TAG_MINOR_VERSION);
+            const ghost_demon ghost = tag_read_random_ghost(r);
+            const int index = ghost.xl - 1;
+            REQUIRE(index >= 0);
+            REQUIRE(index < 5);
+            REQUIRE(ghost.name == ghosts[index].name);
+            REQUIRE(ghost.title == ghosts[index].title);
+            seen.insert(ghost.name);
+        }
+        REQUIRE(seen.size() == 5);
+    }
+}
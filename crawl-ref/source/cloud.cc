@@ -45,9 +45,73 @@
 #include "unwind.h"
 #include "xom.h"
 
+cloud_grid::cloud_grid()
+{
+    slot.init(-1);
+}
+
+/**
+ * Put a copy of the given cloud at p, replacing any cloud already there.
+ *
+ * @return the stored cloud, which stays at the same address until it is
+ *         erased.
+ */
+cloud_struct &cloud_grid::set(const coord_def &p, const cloud_struct &cloud)
+{
+    ASSERT_IN_BOUNDS(p);
+    ASSERT(cloud.defined());
+    if (slot(p) < 0)
+    {
+        slot(p) = occupied.size();
+        occupied.push_back(p);
+    }
+    cells(p) = cloud;
+    cells(p).pos = p;
+    return cells(p);
+}
+
+void cloud_grid::erase(const coord_def &p)
+{
+    const int i = slot(p);
+    if (i < 0)
+        return;
+
+    // Keep the rest of the cloud's fields around: callers may still be
+    // looking at a cloud that has just dissipated.
+    cells(p).type = CLOUD_NONE;
+    slot(p) = -1;
+    if (i != (int)occupied.size() - 1)
+    {
+        occupied[i] = occupied.back();
+        slot(occupied[i]) = i;
+    }
+    occupied.pop_back();
+}
+
+void cloud_grid::clear()
+{
+    for (const coord_def &p : occupied)
+    {
+        cells(p) = cloud_struct();
+        slot(p) = -1;
+    }
+    occupied.clear();
+}
+
+vector<coord_def> cloud_grid::positions() const
+{
+    vector<coord_def> sorted = occupied;
+    sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
 cloud_struct* cloud_at(coord_def pos)
 {
-    return map_find(env.cloud, pos);
+    // Clouds are only ever placed in bounds, and the grid has no cells
+    // beyond the map.
+    if (!in_bounds(pos))
+        return nullptr;
+    return env.cloud.find(pos);
 }
 
 /// damage = base + random2avg(random, random/15 + 1)
@@ -465,10 +529,9 @@ static int _spread_cloud(const cloud_struct &cloud)
         if (newdecay >= cloud.decay)
             newdecay = cloud.decay - 1;
 
-        env.cloud[*ai] = cloud;
-        env.cloud[*ai].pos = *ai;
-        env.cloud[*ai].decay = newdecay;
-        _los_cloud_changed(env.cloud[*ai].pos, env.cloud[*ai].type, CLOUD_NONE);
+        cloud_struct &spread = env.cloud.set(*ai, cloud);
+        spread.decay = newdecay;
+        _los_cloud_changed(spread.pos, spread.type, CLOUD_NONE);
 
         extra_decay += 8;
     }
@@ -492,10 +555,9 @@ static void _spread_fire(const cloud_struct &cloud)
         // burning trees produce flames all around
         if (!cell_is_solid(*ai) && make_flames)
         {
-            env.cloud[*ai] = cloud;
-            env.cloud[*ai].type = CLOUD_FIRE;
-            env.cloud[*ai].pos = *ai;
-            env.cloud[*ai].decay = cloud.decay / 2 + 1;
+            cloud_struct &flames = env.cloud.set(*ai, cloud);
+            flames.type = CLOUD_FIRE;
+            flames.decay = cloud.decay / 2 + 1;
         }
 
         // forest fire doesn't spread in all directions at once,
@@ -512,9 +574,7 @@ static void _spread_fire(const cloud_struct &cloud)
         if (you.see_cell(*ai))
             mpr("The forest fire spreads!");
         destroy_wall(*ai);
-        env.cloud[*ai] = cloud;
-        env.cloud[*ai].pos = *ai;
-        env.cloud[*ai].decay = random2(30) + 25;
+        env.cloud.set(*ai, cloud).decay = random2(30) + 25;
 
     }
 }
@@ -534,10 +594,10 @@ static void _cloud_interacts_with_terrain(const cloud_struct &cloud)
             && one_chance_in(14))
         {
             const cloud_type old = cloud_type_at(p);
-            env.cloud[p] = cloud_struct(p, CLOUD_STEAM, 2 + random2(5),
-                                        11, cloud.whose, cloud.killer,
-                                        cloud.source, -1);
-            _los_cloud_changed(p, env.cloud[p].type, old);
+            env.cloud.set(p, cloud_struct(p, CLOUD_STEAM, 2 + random2(5),
+                                          11, cloud.whose, cloud.killer,
+                                          cloud.source, -1));
+            _los_cloud_changed(p, CLOUD_STEAM, old);
         }
     }
 }
@@ -643,14 +703,13 @@ static void _handle_spectral_cloud(const cloud_struct& cloud)
 
 void manage_clouds()
 {
-    // We can't iterate over env.cloud directly because _dissipate_cloud
-    // will remove this cloud and invalidate our iterator.
-    vector<cloud_struct *> cloud_ptrs;
-    for (auto& entry : env.cloud)
-        cloud_ptrs.push_back(&entry.second);
-
-    for (auto ptr : cloud_ptrs)
+    // Clouds spawned by spreading this turn aren't processed until the
+    // next one, so take a snapshot of where the clouds are now.
+    for (const coord_def &pos : env.cloud.positions())
     {
+        cloud_struct* ptr = cloud_at(pos);
+        if (!ptr)
+            continue;
         cloud_struct& cloud = *ptr;
 
 #ifdef ASSERTS
@@ -700,13 +759,7 @@ void delete_cloud(coord_def p)
 
 void delete_all_clouds()
 {
-    // We can't iterate over env.cloud directly because delete_cloud
-    // will remove this cloud and invalidate our iterator.
-    vector<coord_def> cloud_locs;
-    for (auto& entry : env.cloud)
-        cloud_locs.push_back(entry.first);
-
-    for (auto pos : cloud_locs)
+    for (const coord_def &pos : env.cloud.positions())
         delete_cloud(pos);
 }
 
@@ -720,11 +773,10 @@ void move_cloud(coord_def src, coord_def newpos)
 
     const cloud_type old = cloud_type_at(newpos);
 
-    env.cloud[newpos] = env.cloud[src];
+    const cloud_struct &moved = env.cloud.set(newpos, *cloud_at(src));
     env.cloud.erase(src);
-    env.cloud[newpos].pos = newpos;
-    _los_cloud_changed(src, CLOUD_NONE, env.cloud[newpos].type);
-    _los_cloud_changed(newpos, env.cloud[newpos].type, old);
+    _los_cloud_changed(src, CLOUD_NONE, moved.type);
+    _los_cloud_changed(newpos, moved.type, old);
 }
 
 void swap_clouds(coord_def p1, coord_def p2)
@@ -742,13 +794,11 @@ void swap_clouds(coord_def p1, coord_def p2)
         return;
     }
 
-    cloud_struct temp = env.cloud[p1];
-    env.cloud[p1] = env.cloud[p2];
-    env.cloud[p2] = temp;
-    env.cloud[p1].pos = p1;
-    env.cloud[p2].pos = p2;
-    _los_cloud_changed(p1, env.cloud[p1].type, env.cloud[p2].type);
-    _los_cloud_changed(p2, env.cloud[p2].type, env.cloud[p1].type);
+    const cloud_struct temp = *cloud_at(p1);
+    env.cloud.set(p1, *cloud_at(p2));
+    env.cloud.set(p2, temp);
+    _los_cloud_changed(p1, cloud_at(p1)->type, cloud_at(p2)->type);
+    _los_cloud_changed(p2, cloud_at(p2)->type, cloud_at(p1)->type);
 }
 
 bool cloud_is_stronger(cloud_type ct, const cloud_struct& cloud)
@@ -845,10 +895,10 @@ bool place_cloud(cloud_type cl_type, const coord_def& ctarget, int cl_range,
     // possible to overwrite an opaque cloud with a non-opaque one; OOD will do
     // this.
     const cloud_type old = cloud ? cloud->type : CLOUD_NONE;
-    env.cloud[ctarget] = cloud_struct(ctarget, cl_type, cl_range * 10,
+    env.cloud.set(ctarget, cloud_struct(ctarget, cl_type, cl_range * 10,
             _actual_spread_rate(cl_type, spread_rate), whose, killer, source,
-            excl_rad);
-    _los_cloud_changed(ctarget, env.cloud[ctarget].type, old);
+            excl_rad));
+    _los_cloud_changed(ctarget, cl_type, old);
 
     return true;
 }
@@ -1843,15 +1893,12 @@ void remove_vortex_clouds(mid_t whose)
     // spell (excluding immobile and mindless casters).
     // XXX: this comment seems impossibly out of date? ^
 
-    // We can't iterate over env.cloud directly because delete_cloud
-    // will remove this cloud and invalidate our iterator.
-    vector<coord_def> vortices;
-    for (auto& entry : env.cloud)
-        if (entry.second.type == CLOUD_VORTEX && entry.second.source == whose)
-            vortices.push_back(entry.first);
-
-    for (auto pos : vortices)
-        delete_cloud(pos);
+    for (const coord_def &pos : env.cloud.positions())
+    {
+        const cloud_struct &cloud = *cloud_at(pos);
+        if (cloud.type == CLOUD_VORTEX && cloud.source == whose)
+            delete_cloud(pos);
+    }
 }
 
 static void _spread_cloud(coord_def pos, cloud_type type, int radius, int pow,
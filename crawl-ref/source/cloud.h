@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "fixedarray.h"
+
 struct cloud_struct
 {
     coord_def     pos;
@@ -40,6 +42,42 @@ struct cloud_struct
     static killer_type   whose_to_killer(kill_category whose);
 };
 
+// Per-level cloud storage. Clouds live in a dense grid so that lookups by
+// position are constant-time, and the occupied cells are kept in a compact
+// list so that the (usually few) clouds on a level can be visited without
+// scanning the whole map.
+class cloud_grid
+{
+public:
+    cloud_grid();
+
+    cloud_struct *find(const coord_def &p)
+    {
+        return cells(p).defined() ? &cells(p) : nullptr;
+    }
+    const cloud_struct *find(const coord_def &p) const
+    {
+        return cells(p).defined() ? &cells(p) : nullptr;
+    }
+
+    cloud_struct &set(const coord_def &p, const cloud_struct &cloud);
+    void erase(const coord_def &p);
+    void clear();
+
+    size_t size() const { return occupied.size(); }
+    bool empty() const { return occupied.empty(); }
+
+    // The positions of all clouds, in coord_def order. Anything that rolls
+    // the RNG per cloud must iterate in this order, so that seeded games are
+    // not perturbed by the order in which clouds happened to be created.
+    vector<coord_def> positions() const;
+
+private:
+    FixedArray<cloud_struct, GXM, GYM> cells;
+    FixedArray<short, GXM, GYM> slot;
+    vector<coord_def> occupied;
+};
+
 enum cloud_tile_variation
 {
     CTVARY_NONE,     ///< fixed tile
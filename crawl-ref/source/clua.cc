@@ -13,6 +13,7 @@
 #include "maybe-bool.h"
 #include "misc.h" // erase_val
 #include "options.h"
+#include "profiler.h"
 #include "state.h"
 #include "stringutil.h"
 #include "syscalls.h"
@@ -361,6 +362,7 @@ int CLua::execfile(const char *filename, bool trusted, bool die_on_fail,
 
 bool CLua::runhook(const char *hook, const char *params, ...)
 {
+    PROF_SCOPE(PROF_LUA_HOOK, hook);
     error.clear();
 
     if (!state())
@@ -590,6 +592,7 @@ bool CLua::calltopfn(const char *params, va_list args, int retc,
 maybe_bool CLua::callmbooleanfn(const char *fn, const char *params,
                                 va_list args)
 {
+    PROF_SCOPE(PROF_LUA_HOOK, fn);
     error.clear();
     if (!state())
         return maybe_bool::maybe;
@@ -618,6 +621,7 @@ maybe_bool CLua::callmbooleanfn(const char *fn, const char *params, ...)
 
 maybe_bool CLua::callmaybefn(const char *fn, const char *params, va_list args)
 {
+    PROF_SCOPE(PROF_LUA_HOOK, fn);
     error.clear();
     if (!state())
         return maybe_bool::maybe;
@@ -701,6 +705,7 @@ void CLua::pushglobal(const string &name)
 
 bool CLua::callfn(const char *fn, const char *params, ...)
 {
+    PROF_SCOPE(PROF_LUA_HOOK, fn);
     error.clear();
     if (!state())
         return false;
@@ -730,6 +735,7 @@ bool CLua::callfn(const char *fn, const char *params, ...)
 
 bool CLua::callfn(const char *fn, int nargs, int nret)
 {
+    PROF_SCOPE(PROF_LUA_HOOK, fn ? fn : "(anonymous function)");
     error.clear();
     if (!state())
         return false;
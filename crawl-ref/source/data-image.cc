@@ -0,0 +1,326 @@
+/**
+ * @file
+ * @brief A shared, read-only image of precomputed game data.
+**/
+
+#include "AppHdr.h"
+
+#include "data-image.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <vector>
+#ifdef UNIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "files.h"
+#include "hash.h"
+#include "syscalls.h"
+
+using std::unique_ptr;
+using std::vector;
+
+static const char IMAGE_MAGIC[4] = { 'C', 'D', 'I', 'M' };
+// Bump this whenever the file layout changes; sections have their own
+// layout numbers, which their owners bump instead.
+static const uint32_t IMAGE_VERSION = 1;
+
+// The file starts with an image_header and its section table, followed by
+// the section contents, each starting on an 8-byte boundary.
+struct image_header
+{
+    char     magic[4];
+    uint32_t version;
+    uint32_t section_count;
+    uint32_t reserved;
+};
+
+struct image_section
+{
+    char     name[20];
+    uint32_t layout;
+    uint32_t checksum;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static uint64_t _align8(uint64_t n)
+{
+    return (n + 7) & ~(uint64_t) 7;
+}
+
+static uint32_t _checksum(const char *data, uint64_t size)
+{
+    return hash32(data, size);
+}
+
+namespace
+{
+    class mapped_image
+    {
+    public:
+        mapped_image() : data(nullptr), data_size(0), mapped(false) {}
+        ~mapped_image()
+        {
+#ifdef UNIX
+            if (mapped)
+                munmap(const_cast<char *>(data), data_size);
+#endif
+        }
+        mapped_image(const mapped_image&) = delete;
+        mapped_image &operator=(const mapped_image&) = delete;
+
+        bool open(const string &file);
+        const image_section *find(const string &name) const;
+        const char *contents(const image_section &s) const
+        {
+            return data + s.offset;
+        }
+
+        const image_header *header() const
+        {
+            return reinterpret_cast<const image_header *>(data);
+        }
+        const image_section *sections() const
+        {
+            return reinterpret_cast<const image_section *>(header() + 1);
+        }
+
+    private:
+        const char *data;
+        size_t data_size;
+        bool mapped;
+        vector<uint64_t> buffer; // the contents, where files can't be mapped
+    };
+}
+
+bool mapped_image::open(const string &file)
+{
+#ifdef UNIX
+    const int fd = open_u(file.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) || (size_t) st.st_size < sizeof(image_header))
+    {
+        ::close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return false;
+    data = static_cast<const char *>(map);
+    data_size = st.st_size;
+    mapped = true;
+#else
+    FILE *f = fopen_u(file.c_str(), "rb");
+    if (!f)
+        return false;
+    const size_t size = file_size(f);
+    buffer.resize((size + 7) / 8);
+    const bool read_ok = size >= sizeof(image_header)
+                         && fread(buffer.data(), 1, size, f) == size;
+    fclose(f);
+    if (!read_ok)
+        return false;
+    data = reinterpret_cast<const char *>(buffer.data());
+    data_size = size;
+#endif
+
+    const image_header &h = *header();
+    if (memcmp(h.magic, IMAGE_MAGIC, sizeof(h.magic))
+        || h.version != IMAGE_VERSION
+        || sizeof(image_header) + (uint64_t) h.section_count
+                                  * sizeof(image_section) > data_size)
+    {
+        return false;
+    }
+
+    // A truncated or garbled file gets rebuilt rather than read.
+    for (uint32_t i = 0; i < h.section_count; i++)
+    {
+        const image_section &s = sections()[i];
+        if (s.offset % 8 || s.offset > data_size
+            || s.size > data_size - s.offset
+            || !memchr(s.name, 0, sizeof(s.name))
+            || _checksum(contents(s), s.size) != s.checksum)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const image_section *mapped_image::find(const string &name) const
+{
+    for (uint32_t i = 0; i < header()->section_count; i++)
+        if (name == sections()[i].name)
+            return &sections()[i];
+    return nullptr;
+}
+
+struct pending_section
+{
+    string name;
+    uint32_t layout;
+    const char *data;
+    uint64_t size;
+};
+
+// Write the sections to file, replacing it atomically, so that processes
+// that have the old file mapped keep reading the old contents.
+static bool _write_image(const string &file,
+                         const vector<pending_section> &sections)
+{
+    image_header header;
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+    header.version = IMAGE_VERSION;
+    header.section_count = sections.size();
+    header.reserved = 0;
+
+    vector<image_section> table(sections.size());
+    uint64_t offset = _align8(sizeof(image_header)
+                              + sections.size() * sizeof(image_section));
+    for (size_t i = 0; i < sections.size(); i++)
+    {
+        image_section &s = table[i];
+        memset(&s, 0, sizeof(s));
+        strncpy(s.name, sections[i].name.c_str(), sizeof(s.name) - 1);
+        s.layout = sections[i].layout;
+        s.checksum = _checksum(sections[i].data, sections[i].size);
+        s.offset = offset;
+        s.size = sections[i].size;
+        offset = _align8(offset + s.size);
+    }
+
+    const string tmp = file + ".tmp";
+    FILE *f = fopen_u(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    static const char padding[8] = { 0 };
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+              && fwrite(table.data(), sizeof(image_section), table.size(), f)
+                 == table.size();
+    uint64_t written = sizeof(header) + table.size() * sizeof(image_section);
+    for (size_t i = 0; ok && i < sections.size(); i++)
+    {
+        const size_t pad = table[i].offset - written;
+        ok = fwrite(padding, 1, pad, f) == pad
+             && fwrite(sections[i].data, 1, sections[i].size, f)
+                == sections[i].size;
+        written = table[i].offset + table[i].size;
+    }
+    ok = !fclose(f) && ok;
+    if (ok)
+        ok = !rename_u(tmp.c_str(), file.c_str());
+    if (!ok)
+        unlink_u(tmp.c_str());
+    return ok;
+}
+
+namespace data_image
+{
+    // Empty until open() is called.
+    static string image_path;
+    // Every version of the image this process has mapped, newest last.
+    // Sections handed out stay in use, so none of them are ever unmapped.
+    static vector<unique_ptr<mapped_image>> images;
+    // Sections that couldn't be added to the image.
+    static vector<unique_ptr<vector<uint64_t>>> private_sections;
+
+    static const char *_find(const string &name, uint32_t layout,
+                             size_t *size)
+    {
+        if (images.empty())
+            return nullptr;
+        const mapped_image &image = *images.back();
+        const image_section *s = image.find(name);
+        if (!s || s->layout != layout)
+            return nullptr;
+        *size = s->size;
+        return image.contents(*s);
+    }
+
+    static bool _reopen()
+    {
+        unique_ptr<mapped_image> image(new mapped_image);
+        if (!image->open(image_path))
+            return false;
+        images.push_back(move(image));
+        return true;
+    }
+
+    static const char *_keep_private(const string &bytes, size_t *size)
+    {
+        private_sections.emplace_back(
+            new vector<uint64_t>((bytes.size() + 7) / 8));
+        char *data = reinterpret_cast<char *>(private_sections.back()->data());
+        memcpy(data, bytes.data(), bytes.size());
+        *size = bytes.size();
+        return data;
+    }
+
+    void open()
+    {
+        open(savedir_versioned_path("db/gamedata.img"));
+    }
+
+    void open(const string &file)
+    {
+        if (!image_path.empty())
+            return;
+        image_path = file;
+        _reopen();
+    }
+
+    const char *section(const string &name, uint32_t layout,
+                        const function<string()> &build, size_t *size)
+    {
+        ASSERT(name.size() < sizeof(image_section::name));
+
+        if (const char *found = _find(name, layout, size))
+            return found;
+
+        if (image_path.empty())
+            return _keep_private(build(), size);
+
+        string output_dir = get_parent_directory(image_path);
+        if (!check_mkdir("DB directory", &output_dir, true))
+            return _keep_private(build(), size);
+
+        // Another process may have added the section while we waited.
+        file_lock lock(image_path + ".lk", "wb", false);
+        if (_reopen())
+            if (const char *found = _find(name, layout, size))
+                return found;
+
+        const string bytes = build();
+        vector<pending_section> sections;
+        if (!images.empty())
+        {
+            const mapped_image &old = *images.back();
+            for (uint32_t i = 0; i < old.header()->section_count; i++)
+            {
+                const image_section &s = old.sections()[i];
+                if (name != s.name)
+                {
+                    sections.push_back({ s.name, s.layout, old.contents(s),
+                                         s.size });
+                }
+            }
+        }
+        sections.push_back({ name, layout, bytes.data(), bytes.size() });
+
+        if (_write_image(image_path, sections) && _reopen())
+            if (const char *found = _find(name, layout, size))
+                return found;
+
+        return _keep_private(bytes, size);
+    }
+}
@@ -0,0 +1,36 @@
+/**
+ * @file
+ * @brief A shared, read-only image of precomputed game data.
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+using std::function;
+using std::string;
+
+// Tables that every process computes identically, independent of the game
+// being played, are kept in one versioned file in the db directory. Each
+// subsystem owns a named section of it, laid out without pointers so that
+// it can be used in place; every process maps the file read-only, so they
+// all share the same pages.
+namespace data_image
+{
+    // Use the image in the db directory from now on; before this is called
+    // (as in the tools), sections are just built in memory.
+    void open();
+    // Use the given image file instead, as the tests do.
+    void open(const string &file);
+
+    // The named section, built with build() and added to the image first if
+    // the image has no such section or has one with a different layout. The
+    // bytes are 8-byte aligned and stay valid for the rest of the process.
+    // If the image can't be written, the section is kept in private memory
+    // instead.
+    const char *section(const string &name, uint32_t layout,
+                        const function<string()> &build, size_t *size);
+}
@@ -8,18 +8,15 @@
 #include "database.h"
 
 #include <cstdlib>
-#include <fcntl.h>
-#include <sys/stat.h>
-#include <sys/types.h>
-#if defined(UNIX) || defined(TARGET_COMPILER_MINGW)
-#include <unistd.h>
-#endif
+#include <unordered_map>
 
+#include "blobdb.h"
 #include "clua.h"
 #include "end.h"
 #include "files.h"
 #include "libutil.h"
 #include "options.h"
+#include "profiler.h"
 #include "random.h"
 #include "stringutil.h"
 #include "syscalls.h"
@@ -31,17 +28,15 @@ class TextDB
 {
 public:
     // db_name is the savedir-relative name of the db file,
-    // minus the "db" extension.
+    // minus the ".blob" extension.
     TextDB(const char* db_name, const char* dir, vector<string> files);
     TextDB(TextDB *parent);
     ~TextDB() { shutdown(true); delete translation; }
     void init();
     void shutdown(bool recursive = false);
-    DBM* get() { return _db; }
+    const BlobDB* get() const { return _db; }
 
-    // Make it easier to migrate from raw DBM* to TextDB
     operator bool() const { return _db != 0; }
-    operator DBM*() const { return _db; }
 
  private:
     bool _needs_update() const;
@@ -52,7 +47,7 @@ public:
     const char* const _db_name;
     string _directory;
     vector<string> _input_files;
-    DBM* _db;
+    BlobDB* _db;
     string timestamp;
     TextDB *_parent;
     const char* lang() { return _parent ? Options.lang_name : 0; }
@@ -60,13 +55,19 @@ public:
     TextDB *translation;
 };
 
-// Convenience functions for (read-only) access to generic
-// berkeley DB databases.
-static void _store_text_db(const string &in, DBM *db);
+// The entries read from a database's text files, in the order a later
+// entry with the same key as an earlier one replaces it.
+struct text_db_entries
+{
+    vector<blob_db_record> records;
+    unordered_map<string, size_t> by_key;
+};
+
+static void _store_text_db(const string &in, text_db_entries &db);
 
 static string _query_database(TextDB &db, string key, bool canonicalise_key,
                               bool run_lua, bool untranslated = false);
-static void _add_entry(DBM *db, const string &k, string &v);
+static void _add_entry(text_db_entries &db, const string &k, string &v);
 
 static TextDB AllDBs[] =
 {
@@ -197,10 +198,14 @@ bool TextDB::open_db()
     if (_db)
         return true;
 
-    const string full_db_path = _db_cache_path(_db_name, lang());
-    _db = dbm_open(full_db_path.c_str(), O_RDONLY, 0660);
-    if (!_db)
+    const string full_db_path = _db_cache_path(_db_name, lang()) + ".blob";
+    _db = new BlobDB;
+    if (!_db->open(full_db_path))
+    {
+        delete _db;
+        _db = nullptr;
         return false;
+    }
 
     timestamp = _query_database(*this, "TIMESTAMP", false, false, true);
     if (timestamp.empty())
@@ -234,7 +239,7 @@ void TextDB::shutdown(bool recursive)
 {
     if (_db)
     {
-        dbm_close(_db);
+        delete _db;
         _db = nullptr;
     }
     if (recursive && translation)
@@ -299,7 +304,7 @@ void TextDB::_regenerate_db()
     }
 
     string db_path = _db_cache_path(_db_name, lang());
-    string full_db_path = db_path + ".db";
+    string full_db_path = db_path + ".blob";
 
     {
         string output_dir = get_parent_directory(db_path);
@@ -307,14 +312,13 @@ void TextDB::_regenerate_db()
             end(1, false, "Cannot create db directory '%s'.", output_dir.c_str());
     }
 
+    // The new blob replaces the old one atomically, so processes still
+    // reading the old one are unaffected; the lock only stops two processes
+    // from building it at once.
     file_lock lock(db_path + ".lk", "wb");
-#ifndef DGL_REWRITE_PROTECT_DB_FILES
-    unlink_u(full_db_path.c_str());
-#endif
 
     string ts;
-    if (!(_db = dbm_open(db_path.c_str(), O_RDWR | O_CREAT, 0660)))
-        end(1, true, "Unable to open DB: %s", db_path.c_str());
+    text_db_entries entries;
     for (const string &file : _input_files)
     {
         string full_input_path = _directory + file;
@@ -326,13 +330,16 @@ void TextDB::_regenerate_db()
         {
             snprintf(buf, sizeof(buf), ":%" PRId64, (int64_t)mtime);
             ts += buf;
-            _store_text_db(full_input_path, _db);
+            _store_text_db(full_input_path, entries);
         }
     }
-    _add_entry(_db, "TIMESTAMP", ts);
+    _add_entry(entries, "TIMESTAMP", ts);
+
+    for (blob_db_record &record : entries.records)
+        _split_weighted_string(record.value, record.alternatives);
 
-    dbm_close(_db);
-    _db = 0;
+    if (!write_blob_db(full_db_path, entries.records))
+        end(1, true, "Unable to write DB: %s", full_db_path.c_str());
 }
 
 // ----------------------------------------------------------------------
@@ -356,24 +363,35 @@ void databaseSystemShutdown()
 ////////////////////////////////////////////////////////////////////////////
 // Main DB functions
 
-static datum _database_fetch(DBM *database, const string &key)
+// The entry for key, or nullptr if there's none or it's empty.
+static const blob_entry *_database_fetch(const BlobDB *database,
+                                         const string &key)
 {
-    datum result;
-    result.dptr = nullptr;
-    result.dsize = 0;
-    datum dbKey;
-
-    dbKey.dptr = (DPTR_COERCE) key.c_str();
-    dbKey.dsize = key.length();
-
     // Don't use the database if called from "monster".
-    if (database)
-        result = dbm_fetch(database, dbKey);
+    if (!database)
+        return nullptr;
+
+    const blob_entry *entry = database->find(key);
+    return entry && entry->value_length ? entry : nullptr;
+}
 
-    return result;
+// Look key up in the translation first, if there is one, and then in the
+// English database. Sets found_in to whichever had it.
+static const blob_entry *_translated_fetch(const TextDB &db, const string &key,
+                                           const BlobDB *&found_in,
+                                           bool untranslated = false)
+{
+    if (db.translation && !untranslated)
+    {
+        found_in = db.translation->get();
+        if (const blob_entry *entry = _database_fetch(found_in, key))
+            return entry;
+    }
+    found_in = db.get();
+    return _database_fetch(found_in, key);
 }
 
-static vector<string> _database_find_keys(DBM *database,
+static vector<string> _database_find_keys(const BlobDB *database,
                                           const string &regex,
                                           bool ignore_case,
                                           db_find_filter filter = nullptr)
@@ -381,11 +399,9 @@ static vector<string> _database_find_keys(DBM *database,
     text_pattern             tpat(regex, ignore_case);
     vector<string> matches;
 
-    datum dbKey = dbm_firstkey(database);
-
-    while (dbKey.dptr != nullptr)
+    for (uint32_t i = 0; i < database->size(); i++)
     {
-        string key((const char *)dbKey.dptr, dbKey.dsize);
+        const string key = database->key(database->entry(i));
 
         if (tpat.matches(key)
             && key.find("__") == string::npos
@@ -393,14 +409,12 @@ static vector<string> _database_find_keys(DBM *database,
         {
             matches.push_back(key);
         }
-
-        dbKey = dbm_nextkey(database);
     }
 
     return matches;
 }
 
-static vector<string> _database_find_bodies(DBM *database,
+static vector<string> _database_find_bodies(const BlobDB *database,
                                             const string &regex,
                                             bool ignore_case,
                                             db_find_filter filter = nullptr)
@@ -408,14 +422,11 @@ static vector<string> _database_find_bodies(DBM *database,
     text_pattern             tpat(regex, ignore_case);
     vector<string> matches;
 
-    datum dbKey = dbm_firstkey(database);
-
-    while (dbKey.dptr != nullptr)
+    for (uint32_t i = 0; i < database->size(); i++)
     {
-        string key((const char *)dbKey.dptr, dbKey.dsize);
-
-        datum dbBody = dbm_fetch(database, dbKey);
-        string body((const char *)dbBody.dptr, dbBody.dsize);
+        const blob_entry &entry = database->entry(i);
+        const string key = database->key(entry);
+        const string body = database->value(entry);
 
         if (tpat.matches(body)
             && key.find("__") == string::npos
@@ -423,8 +434,6 @@ static vector<string> _database_find_bodies(DBM *database,
         {
             matches.push_back(key);
         }
-
-        dbKey = dbm_nextkey(database);
     }
 
     return matches;
@@ -496,21 +505,24 @@ static void _trim_leading_newlines(string &s)
     s.erase(0, s.find_first_not_of("\n"));
 }
 
-static void _add_entry(DBM *db, const string &k, string &v)
+static void _add_entry(text_db_entries &db, const string &k, string &v)
 {
     _trim_leading_newlines(v);
-    datum key, value;
-    key.dptr = (char *) k.c_str();
-    key.dsize = k.length();
-
-    value.dptr = (char *) v.c_str();
-    value.dsize = v.length();
 
-    if (dbm_store(db, key, value, DBM_REPLACE))
-        end(1, true, "Error storing %s", k.c_str());
+    // A repeated key replaces the earlier entry, and moves to the end.
+    auto old = db.by_key.find(k);
+    if (old != db.by_key.end())
+    {
+        db.records.erase(db.records.begin() + old->second);
+        for (auto &entry : db.by_key)
+            if (entry.second > old->second)
+                entry.second--;
+    }
+    db.by_key[k] = db.records.size();
+    db.records.push_back({ k, v, {} });
 }
 
-static void _parse_text_db(LineInput &inf, DBM *db)
+static void _parse_text_db(LineInput &inf, text_db_entries &db)
 {
     string key;
     string value;
@@ -553,7 +565,7 @@ static void _parse_text_db(LineInput &inf, DBM *db)
         _add_entry(db, key, value);
 }
 
-static void _store_text_db(const string &in, DBM *db)
+static void _store_text_db(const string &in, text_db_entries &db)
 {
     UTF8FileLineInput inf(in.c_str());
     if (inf.error())
@@ -562,11 +574,12 @@ static void _store_text_db(const string &in, DBM *db)
     _parse_text_db(inf, db);
 }
 
-static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
+// Split an entry into its alternatives, each with the total weight of it and
+// those before it. Returns an error message if the entry is malformed.
+const char *_split_weighted_string(const string &entry,
+                                   vector<pair<string, int>> &parts)
 {
-    vector<string> parts;
-    vector<int>    weights;
-
+    parts.clear();
     vector<string> lines = split_string("\n", entry, false, true);
 
     int total_weight = 0;
@@ -587,7 +600,10 @@ static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
         {
             i++;
             if (i == size)
+            {
+                parts.clear();
                 return "BUG, WEIGHT AT END OF ENTRY";
+            }
         }
         else
             weight = 10;
@@ -601,22 +617,62 @@ static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
         }
         trim_string(part);
 
-        parts.push_back(part);
-        weights.push_back(total_weight);
+        parts.emplace_back(part, total_weight);
     }
 
     if (parts.empty())
         return "BUG, EMPTY ENTRY";
 
+    // Nothing could ever be chosen.
+    if (total_weight <= 0)
+    {
+        parts.clear();
+        return "BUG, NO STRING CHOSEN";
+    }
+    return nullptr;
+}
+
+static string _chooseStrByWeight(const string &entry, int fixed_weight = -1)
+{
+    vector<pair<string, int>> parts;
+    if (const char *error = _split_weighted_string(entry, parts))
+        return error;
+
+    const int total_weight = parts.back().second;
     int choice = 0;
     if (fixed_weight != -1)
         choice = fixed_weight % total_weight;
     else
         choice = random2(total_weight);
 
-    for (int i = 0, size = parts.size(); i < size; i++)
-        if (choice < weights[i])
-            return parts[i];
+    for (const auto &part : parts)
+        if (choice < part.second)
+            return part.first;
+
+    return "BUG, NO STRING CHOSEN";
+}
+
+// As _chooseStrByWeight(), but using the alternatives split out when the
+// database was built.
+static string _chooseEntryByWeight(const BlobDB &db, const blob_entry &entry,
+                                   int fixed_weight = -1)
+{
+    if (!entry.alternative_count)
+    {
+        profiler::count(PROF_COUNTER, "db entries split at lookup");
+        return _chooseStrByWeight(db.value(entry), fixed_weight);
+    }
+
+    int choice = 0;
+    if (fixed_weight != -1)
+        choice = fixed_weight % entry.total_weight;
+    else
+        choice = random2(entry.total_weight);
+
+    const blob_alternative *alts = db.alternatives(entry);
+    for (uint32_t i = 0; i < entry.alternative_count; i++)
+        if (choice < (int) alts[i].weight)
+            return db.text(alts[i]);
 
     return "BUG, NO STRING CHOSEN";
 }
@@ -633,33 +689,23 @@ static string _getWeightedString(TextDB &db, const string &key,
     lowercase(canonical_key);
 
     // Query the DB.
-    datum result;
-
-    if (db.translation)
-        result = _database_fetch(db.translation->get(), canonical_key);
-    if (result.dsize <= 0)
-        result = _database_fetch(db.get(), canonical_key);
+    const BlobDB *found_in;
+    const blob_entry *result = _translated_fetch(db, canonical_key, found_in);
 
-    if (result.dsize <= 0)
+    if (!result)
     {
         // Try ignoring the suffix.
         canonical_key = key;
         lowercase(canonical_key);
 
         // Query the DB.
-        if (db.translation)
-            result = _database_fetch(db.translation->get(), canonical_key);
-        if (result.dsize <= 0)
-            result = _database_fetch(db.get(), canonical_key);
+        result = _translated_fetch(db, canonical_key, found_in);
 
-        if (result.dsize <= 0)
+        if (!result)
             return "";
     }
 
-    // Cons up a (C++) string to return. The caller must release it.
-    string str = string((const char *)result.dptr, result.dsize);
-
-    return _chooseStrByWeight(str, fixed_weight);
+    return _chooseEntryByWeight(*found_in, *result, fixed_weight);
 }
 
 static void _call_recursive_replacement(string &str, TextDB &db,
@@ -747,17 +793,13 @@ static string _query_database(TextDB &db, string key, bool canonicalise_key,
     }
 
     // Query the DB.
-    datum result;
-
-    if (db.translation && !untranslated)
-        result = _database_fetch(db.translation->get(), key);
-    if (result.dsize <= 0)
-        result = _database_fetch(db.get(), key);
-
-    if (result.dsize <= 0)
+    const BlobDB *found_in;
+    const blob_entry *result = _translated_fetch(db, key, found_in,
+                                                 untranslated);
+    if (!result)
         return "";
 
-    string str((const char *)result.dptr, result.dsize);
+    string str = found_in->value(*result);
 
     // <foo> is an alias to key foo
     if (str[0] == '<' && str[str.size() - 2] == '>'
@@ -818,8 +860,7 @@ vector<string> getLongDescBodiesByRegex(const string &regex,
     // On partial translations, this will match only translated descriptions.
     // Not good, but otherwise we'd have to check hundreds of keys, with
     // two queries for each.
-    // SQL can do this in one go, DBM can't.
-    DBM *database = DescriptionDB.translation ?
+    const BlobDB *database = DescriptionDB.translation ?
         DescriptionDB.translation->get() : DescriptionDB.get();
     return _database_find_bodies(database, regex, true, filter);
 }
@@ -346,6 +346,13 @@ void debug_mons_scan()
         ASSERT(m->mid > 0);
         coord_def pos = m->pos();
 
+        if (!binary_search(env.mon_slots.begin(), env.mon_slots.end(), i))
+        {
+            mprf(MSGCH_ERROR, "Monster %s at (%d, %d), midx = %d, is missing "
+                              "from the monster slot list",
+                 m->full_name(DESC_PLAIN).c_str(), pos.x, pos.y, i);
+        }
+
         if (invalid_monster_type(m->type))
         {
             mprf(MSGCH_ERROR, "Bogus monster type %d at (%d, %d), midx = %d",
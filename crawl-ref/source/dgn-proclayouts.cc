@@ -32,6 +32,15 @@ static dungeon_feature_type _pick_pseudorandom_wall(uint64_t val)
     return features[val%9];
 }
 
+void ProceduralLayout::sample_all(const vector<coord_def> &ps,
+                                  const uint32_t offset,
+                                  vector<ProceduralSample> &out) const
+{
+    out.reserve(out.size() + ps.size());
+    for (const coord_def &p : ps)
+        out.push_back((*this)(p, offset));
+}
+
 ProceduralSample
 ColumnLayout::operator()(const coord_def &p, const uint32_t offset) const
 {
@@ -66,29 +75,75 @@ static uint32_t _get_changepoint(const worley::noise_datum &n, const double scal
     return max(1, (int) floor((n.distance[1] - n.distance[0]) * scale) - 5);
 }
 
-ProceduralSample
-WorleyLayout::operator()(const coord_def &p, const uint32_t offset) const
+static const double WORLEY_OFFSET_SCALE = 5000.0;
+
+// Which of the layouts should be used at p, and the point to sample it at.
+int WorleyLayout::_choose(const coord_def &p, const uint32_t offset,
+                          worley::noise_datum &n, coord_def &pd) const
 {
-    const double offset_scale = 5000.0;
     double x = p.x / scale;
     double y = p.y / scale;
-    double z = offset / offset_scale;
-    worley::noise_datum n = worley::noise(x, y, z + seed);
+    double z = offset / WORLEY_OFFSET_SCALE;
+    n = worley::noise(x, y, z + seed);
 
-    const uint32_t changepoint = offset + _get_changepoint(n, offset_scale);
     const uint8_t size = layouts.size();
     bool parity = n.id[0] % 4;
     uint32_t id = n.id[0] / 4;
     const uint8_t choice = parity
         ? id % size
         : min(id % size, (id / size) % size);
-    const coord_def pd = p + id;
-    ProceduralSample sample = (*layouts[(choice + seed) % size])(pd, offset);
+    pd = p + id;
+    return (choice + seed) % size;
+}
+
+ProceduralSample
+WorleyLayout::operator()(const coord_def &p, const uint32_t offset) const
+{
+    worley::noise_datum n;
+    coord_def pd;
+    const int layout = _choose(p, offset, n, pd);
+
+    const uint32_t changepoint = offset
+                                 + _get_changepoint(n, WORLEY_OFFSET_SCALE);
+    ProceduralSample sample = (*layouts[layout])(pd, offset);
 
     return ProceduralSample(p, sample.feat(),
                 min(changepoint, sample.changepoint()));
 }
 
+void WorleyLayout::sample_all(const vector<coord_def> &ps,
+                              const uint32_t offset,
+                              vector<ProceduralSample> &out) const
+{
+    // Group the points by the layout chosen for them, so that each layout
+    // gets a single batch.
+    vector<int> choices(ps.size());
+    vector<uint32_t> changepoints(ps.size());
+    vector<vector<coord_def>> groups(layouts.size());
+    for (size_t i = 0; i < ps.size(); ++i)
+    {
+        worley::noise_datum n;
+        coord_def pd;
+        choices[i] = _choose(ps[i], offset, n, pd);
+        changepoints[i] = offset + _get_changepoint(n, WORLEY_OFFSET_SCALE);
+        groups[choices[i]].push_back(pd);
+    }
+
+    vector<vector<ProceduralSample>> results(layouts.size());
+    for (size_t l = 0; l < layouts.size(); ++l)
+        if (!groups[l].empty())
+            layouts[l]->sample_all(groups[l], offset, results[l]);
+
+    vector<size_t> next(layouts.size(), 0);
+    out.reserve(out.size() + ps.size());
+    for (size_t i = 0; i < ps.size(); ++i)
+    {
+        const ProceduralSample &sample = results[choices[i]][next[choices[i]]++];
+        out.emplace_back(ps[i], sample.feat(),
+                         min(changepoints[i], sample.changepoint()));
+    }
+}
+
 ProceduralSample
 ChaosLayout::operator()(const coord_def &p, const uint32_t offset) const
 {
@@ -126,32 +181,70 @@ WastesLayout::operator()(const coord_def &p, const uint32_t offset) const
     return ProceduralSample(p, feat, min(sample.changepoint(), changepoint));
 }
 
-ProceduralSample
-RiverLayout::operator()(const coord_def &p, const uint32_t offset) const
+// Is there river at p? If so, set its feature and changepoint.
+bool RiverLayout::_river_at(const coord_def &p, const uint32_t offset,
+                            dungeon_feature_type &feat, uint32_t &cp) const
 {
     const double scale = 10000;
     const double scalar = 90.0;
     double x = (p.x + perlin::fBM(p.x/4.0, p.y/4.0, seed, 5) * 3) / scalar;
     double y = (p.y + perlin::fBM(p.x/4.0 + 3.7, p.y/4.0 + 1.9, seed + 4, 5) * 3) / scalar;
     worley::noise_datum n = worley::noise(x, y, offset / scale + seed);
-    const uint32_t changepoint = offset + _get_changepoint(n, scale);
     if ((n.id[0] ^ n.id[1] ^ seed) % 4)
-        return layout(p, offset);
+        return false;
 
     double delta = n.distance[1] - n.distance[0];
     if (delta < 1.5/scalar)
     {
-        dungeon_feature_type feat = DNGN_SHALLOW_WATER;
+        feat = DNGN_SHALLOW_WATER;
         uint64_t hash = hash3(p.x, p.y, n.id[0] + seed);
         if (!(hash % 5))
             feat = DNGN_DEEP_WATER;
         if (!(hash % 23))
             feat = DNGN_TREE;
-        return ProceduralSample(p, feat, changepoint);
+        cp = offset + _get_changepoint(n, scale);
+        return true;
     }
+    return false;
+}
+
+ProceduralSample
+RiverLayout::operator()(const coord_def &p, const uint32_t offset) const
+{
+    dungeon_feature_type feat;
+    uint32_t cp;
+    if (_river_at(p, offset, feat, cp))
+        return ProceduralSample(p, feat, cp);
     return layout(p, offset);
 }
 
+void RiverLayout::sample_all(const vector<coord_def> &ps,
+                             const uint32_t offset,
+                             vector<ProceduralSample> &out) const
+{
+    vector<bool> is_river(ps.size());
+    vector<ProceduralSample> rivers;
+    vector<coord_def> land_ps;
+    for (size_t i = 0; i < ps.size(); ++i)
+    {
+        dungeon_feature_type feat;
+        uint32_t cp;
+        is_river[i] = _river_at(ps[i], offset, feat, cp);
+        if (is_river[i])
+            rivers.emplace_back(ps[i], feat, cp);
+        else
+            land_ps.push_back(ps[i]);
+    }
+
+    vector<ProceduralSample> land;
+    layout.sample_all(land_ps, offset, land);
+
+    size_t r = 0, l = 0;
+    out.reserve(out.size() + ps.size());
+    for (size_t i = 0; i < ps.size(); ++i)
+        out.push_back(is_river[i] ? rivers[r++] : land[l++]);
+}
+
 ProceduralSample
 NewAbyssLayout::operator()(const coord_def &p, const uint32_t offset) const
 {
@@ -295,6 +388,29 @@ LevelLayout::operator()(const coord_def &p, const uint32_t offset) const
     return ProceduralSample(p, feat, offset + 4096);
 }
 
+void LevelLayout::sample_all(const vector<coord_def> &ps,
+                             const uint32_t offset,
+                             vector<ProceduralSample> &out) const
+{
+    vector<coord_def> unseen;
+    for (const coord_def &p : ps)
+        if (grid(clip(p)) == DNGN_UNSEEN)
+            unseen.push_back(p);
+    vector<ProceduralSample> fallback;
+    layout.sample_all(unseen, offset, fallback);
+
+    size_t f = 0;
+    out.reserve(out.size() + ps.size());
+    for (const coord_def &p : ps)
+    {
+        const dungeon_feature_type feat = grid(clip(p));
+        if (feat == DNGN_UNSEEN)
+            out.push_back(fallback[f++]);
+        else
+            out.emplace_back(p, feat, offset + 4096);
+    }
+}
+
 ProceduralSample
 NoiseLayout::operator()(const coord_def &p, const uint32_t offset) const
 {
@@ -58,6 +58,13 @@ class ProceduralLayout
     public:
         virtual ProceduralSample operator()(const coord_def &p,
             const uint32_t offset = 0) const = 0;
+        // Sample every point in ps, appending the results to out in the same
+        // order. The results are identical to calling operator() on each
+        // point; layouts that delegate to other layouts override this so
+        // that the whole batch is passed down with one call per child,
+        // rather than one virtual call per cell per level of nesting.
+        virtual void sample_all(const vector<coord_def> &ps,
+            const uint32_t offset, vector<ProceduralSample> &out) const;
         virtual ~ProceduralLayout() { }
 };
 
@@ -101,7 +108,11 @@ class WorleyLayout : public ProceduralLayout
             seed(_seed), layouts(_layouts), scale(_scale) {}
         ProceduralSample operator()(const coord_def &p,
             const uint32_t offset = 0) const override;
+        void sample_all(const vector<coord_def> &ps, const uint32_t offset,
+            vector<ProceduralSample> &out) const override;
     private:
+        int _choose(const coord_def &p, const uint32_t offset,
+                    worley::noise_datum &n, coord_def &pd) const;
         const uint32_t seed;
         const vector<const ProceduralLayout*> layouts;
         const float scale;
@@ -154,7 +165,11 @@ class RiverLayout : public ProceduralLayout
             seed(_seed), layout(_layout) {}
         ProceduralSample operator()(const coord_def &p,
             const uint32_t offset = 0) const override;
+        void sample_all(const vector<coord_def> &ps, const uint32_t offset,
+            vector<ProceduralSample> &out) const override;
     private:
+        bool _river_at(const coord_def &p, const uint32_t offset,
+                       dungeon_feature_type &feat, uint32_t &cp) const;
         const uint32_t seed;
         const ProceduralLayout &layout;
 };
@@ -179,6 +194,8 @@ class LevelLayout : public ProceduralLayout
             const ProceduralLayout &_layout);
         ProceduralSample operator()(const coord_def &p,
             const uint32_t offset = 0) const override;
+        void sample_all(const vector<coord_def> &ps, const uint32_t offset,
+            vector<ProceduralSample> &out) const override;
     private:
         feature_grid grid;
         uint32_t seed;
@@ -28,8 +28,10 @@
 #include "macro.h"
 #include "message.h"
 #include "misc.h"
+#include "profiler.h"
 #include "prompt.h"
 #include "religion.h"
+#include "replay.h"
 #include "startup.h"
 #include "state.h"
 #include "stringutil.h"
@@ -212,6 +214,8 @@ NORETURN void end(int exit_code, bool print_error, const char *format, ...)
 void delete_files()
 {
     crawl_state.need_save = false;
+    discard_resident_levels();
+    delete_save_info(you.save->get_filename());
     you.save->unlink();
     delete you.save;
     you.save = 0;
@@ -433,6 +437,9 @@ NORETURN void end_game(scorefile_entry &se)
 
 NORETURN void game_ended(game_exit exit, const string &message)
 {
+    profiler::write_jsonl();
+    replay::game_ended();
+
     if (crawl_state.marked_as_won &&
         (exit == game_exit::death || exit == game_exit::leave))
     {
@@ -42,6 +42,13 @@ struct crawl_environment
     // completely safe if it's an overestimate - just not an underestimate.
     int                             max_mon_index;
 
+    // Indices into mons, in increasing order, of every slot that
+    // get_free_monster() has handed out or a level load has filled, and that
+    // has not since been found empty by clear_monster_flags(). Every slot
+    // holding a monster is listed (dead monsters may be too), so the monster
+    // iterators walk this instead of testing every slot up to max_mon_index.
+    vector<int>                     mon_slots;
+
     feature_grid                             grid;  // terrain grid
     FixedArray<terrain_property_t, GXM, GYM> pgrid; // terrain properties
     FixedArray< unsigned short, GXM, GYM >   mgrid; // monster grid
@@ -77,7 +84,7 @@ struct crawl_environment
 
     vector<coord_def>                        travel_trail;
 
-    map<coord_def, cloud_struct> cloud;
+    cloud_grid cloud;
 
     map<coord_def, shop_struct> shop; // shop list
 
@@ -68,6 +68,7 @@
 #include "macro.h"
 #include "map-knowledge.h"
 #include "mapmark.h"
+#include "mem-usage.h"
 #include "message.h"
 #include "mon-behv.h"
 #include "mon-death.h"
@@ -77,6 +78,7 @@
 #include "place.h"
 #include "prompt.h"
 #include "religion.h"
+#include "replay.h"
 #include "skills.h"
 #include "species.h"
 #include "spl-summoning.h"
@@ -141,7 +143,12 @@ static bool _ghost_version_compatible(const save_version &version);
 
 static bool _restore_tagged_chunk(package *save, const string &name,
                                   tag_type tag, const char* complaint);
+static bool _restore_tagged_reader(reader &inf, const string &name,
+                                   tag_type tag, const char* complaint);
+static void _restore_level_chunk(const string &name, const char* complaint);
 static player_save_info _read_character_info(package *save);
+static player_save_info _read_character_info(reader &inf,
+                                             const string &filename);
 
 static bool _convert_obsolete_species();
 
@@ -694,7 +701,6 @@ string savedir_versioned_path(const string &shortpath)
     return catpath(versioned_dir, shortpath);
 }
 
-#ifdef USE_TILE
 #define LINEMAX 1024
 static bool _readln(chunk_reader &rd, char *buf)
 {
@@ -710,7 +716,24 @@ static bool _readln(chunk_reader &rd, char *buf)
     return true;
 }
 
-static void _fill_player_doll(player_save_info &p, package *save)
+// Read the first line of the save's doll chunk, if it has one.
+static bool _read_doll_line(package *save, string &line)
+{
+    if (!save->has_chunk("tdl"))
+        return false;
+
+    chunk_reader fdoll(save, "tdl");
+    char fbuf[LINEMAX];
+    if (!_readln(fdoll, fbuf))
+        return false;
+    line = fbuf;
+    return true;
+}
+
+#ifdef USE_TILE
+// Fill in the doll from the first line of the save's doll chunk, or with
+// the default doll if line is null.
+static void _fill_player_doll(player_save_info &p, const string *line)
 {
     dolls_data equip_doll;
     for (unsigned int j = 0; j < TILEP_PART_MAX; ++j)
@@ -721,15 +744,13 @@ static void _fill_player_doll(player_save_info &p, package *save)
 
     bool success = false;
 
-    chunk_reader fdoll(save, "tdl");
+    if (line)
     {
-        char fbuf[LINEMAX];
-        if (_readln(fdoll,fbuf))
-        {
-            tilep_scan_parts(fbuf, equip_doll, p.species, p.experience_level);
-            tilep_race_default(p.species, p.experience_level, &equip_doll);
-            success = true;
-        }
+        char fbuf[LINEMAX] = {};
+        strncpy(fbuf, line->c_str(), LINEMAX - 1);
+        tilep_scan_parts(fbuf, equip_doll, p.species, p.experience_level);
+        tilep_race_default(p.species, p.experience_level, &equip_doll);
+        success = true;
     }
 
     if (!success) // Use default doll instead.
@@ -744,6 +765,198 @@ static void _fill_player_doll(player_save_info &p, package *save)
 }
 #endif
 
+/*
+ * Save info sidecars. Next to each save is a small "<save>.info" file holding
+ * the save's character info chunk and the first line of its doll chunk, along
+ * with the save's size and modification time. Listing saves, or looking one
+ * up for webtiles, reads the sidecar instead of opening the save, and only
+ * opens a save whose sidecar is missing or doesn't match it, writing a fresh
+ * sidecar as it goes. The current game's sidecar is rewritten whenever it is
+ * saved, and deleted along with the save.
+ *
+ * A sidecar is only ever a cache: one that doesn't match its save, or can't
+ * be read, is ignored and rewritten.
+ */
+#define SAVE_INFO_SUFFIX ".info"
+#define SAVE_INFO_FORMAT 1
+
+struct save_info_record
+{
+    int64_t mtime = 0;
+    int64_t size = 0;
+    string chr;             // the raw "chr" chunk
+    bool has_doll = false;  // whether there's a "tdl" chunk
+    bool doll_read = false; // and whether its first line could be read
+    string doll;
+};
+
+static string _save_info_path(const string &save_path)
+{
+    return save_path + SAVE_INFO_SUFFIX;
+}
+
+static void _marshall_info_string(writer &th, const string &data)
+{
+    marshallInt(th, data.size());
+    th.write(data.data(), data.size());
+}
+
+static string _unmarshall_info_string(reader &th)
+{
+    const int len = unmarshallInt(th);
+    if (len < 0 || len > 4096) // nothing here should be anywhere near that
+        throw short_read_exception();
+    string data(len, '\0');
+    th.read(&data[0], len);
+    return data;
+}
+
+static bool _save_file_stamp(const string &path, int64_t &mtime,
+                             int64_t &size)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st))
+        return false;
+    mtime = st.st_mtime;
+    size = st.st_size;
+    return true;
+}
+
+static bool _read_save_info_record(const string &save_path,
+                                   save_info_record &rec)
+{
+    FILE *handle = lk_open("rb", _save_info_path(save_path));
+    if (!handle)
+        return false;
+
+    bool ok = false;
+    try
+    {
+        reader th(handle);
+        if (unmarshallInt(th) == SAVE_INFO_FORMAT)
+        {
+            rec.mtime = unmarshallSigned(th);
+            rec.size = unmarshallSigned(th);
+            rec.chr = _unmarshall_info_string(th);
+            rec.has_doll = unmarshallBoolean(th);
+            rec.doll_read = unmarshallBoolean(th);
+            rec.doll = _unmarshall_info_string(th);
+            ok = true;
+        }
+    }
+    catch (short_read_exception &)
+    {
+    }
+
+    lk_close(handle);
+    return ok;
+}
+
+// Each sidecar belongs to one save, so it is rewritten whole under its own
+// lock; there is nothing to merge with other saves' info.
+static void _write_save_info_record(const string &save_path,
+                                    const save_info_record &rec)
+{
+    vector<unsigned char> buf;
+    writer th(&buf);
+    marshallInt(th, SAVE_INFO_FORMAT);
+    marshallSigned(th, rec.mtime);
+    marshallSigned(th, rec.size);
+    _marshall_info_string(th, rec.chr);
+    marshallBoolean(th, rec.has_doll);
+    marshallBoolean(th, rec.doll_read);
+    _marshall_info_string(th, rec.doll);
+
+    // Failing to write the sidecar just means more work next time.
+    FILE *handle = lk_open("a+b", _save_info_path(save_path));
+    if (!handle)
+        return;
+    if (!ftruncate(fileno(handle), 0))
+        fwrite(buf.data(), 1, buf.size(), handle);
+    lk_close(handle);
+}
+
+/// Delete the save info sidecar of a save that is being deleted.
+void delete_save_info(const string &save_path)
+{
+    unlink_u(_save_info_path(save_path).c_str());
+}
+
+static save_info_record _make_save_info_record(package &save)
+{
+    save_info_record rec;
+    vector<char> chr;
+    chunk_reader(&save, "chr").read_all(chr);
+    rec.chr.assign(chr.begin(), chr.end());
+    rec.has_doll = save.has_chunk("tdl");
+    if (rec.has_doll)
+        rec.doll_read = _read_doll_line(&save, rec.doll);
+    return rec;
+}
+
+// Fail in the same way as opening the save would, if another process has it.
+static void _check_save_not_in_use(const string &path)
+{
+    const int fd = open_u(path.c_str(), O_RDONLY | O_BINARY, 0666);
+    if (fd == -1)
+        return;
+    const bool locked = lock_file(fd, false);
+    if (locked)
+        unlock_file(fd);
+    close(fd);
+    if (!locked)
+    {
+        game_ended(game_exit::abort,
+                   "Another game is already in progress using this save!");
+    }
+}
+
+/**
+ * Get a save's info from its sidecar, bringing the sidecar up to date first
+ * if needed.
+ *
+ * @param path  The path to the save.
+ * @return      The up to date info. Throws exactly as opening the save
+ *              would, if it can't be read or is in use.
+ */
+static save_info_record _cached_save_info(const string &path)
+{
+    int64_t mtime = 0, size = 0;
+    const bool stamped = _save_file_stamp(path, mtime, size);
+
+    save_info_record rec;
+    if (stamped && _read_save_info_record(path, rec)
+        && rec.mtime == mtime && rec.size == size)
+    {
+        _check_save_not_in_use(path);
+        return rec;
+    }
+
+    package save(path.c_str(), false);
+    rec = _make_save_info_record(save);
+    rec.mtime = mtime;
+    rec.size = size;
+    if (stamped)
+        _write_save_info_record(path, rec);
+    return rec;
+}
+
+static player_save_info _save_info_from_record(const save_info_record &rec,
+                                               const string &path)
+{
+    const vector<unsigned char> chr(rec.chr.begin(), rec.chr.end());
+    reader inf(chr);
+    return _read_character_info(inf, path);
+}
+
+// Update the sidecar of the current game's save, which must have just been
+// written out.
+static void _update_save_info(const string &path, save_info_record rec)
+{
+    if (_save_file_stamp(path, rec.mtime, rec.size))
+        _write_save_info_record(path, rec);
+}
+
 /*
  * Returns a list of the names of characters that are already saved for the
  * current user.
@@ -762,20 +975,34 @@ static vector<player_save_info> _find_saved_characters()
     if (searchpath.empty())
         searchpath = ".";
 
-    for (const string &filename : get_dir_files_sorted(searchpath))
+    const vector<string> files = get_dir_files_sorted(searchpath);
+    const set<string> file_set(files.begin(), files.end());
+
+    for (const string &filename : files)
     {
+        // Forget the info of saves that have gone away.
+        if (ends_with(filename, SAVE_SUFFIX SAVE_INFO_SUFFIX)
+            && !file_set.count(filename.substr(0, filename.size()
+                                                  - strlen(SAVE_INFO_SUFFIX))))
+        {
+            unlink_u(_get_savedir_path(filename).c_str());
+            continue;
+        }
+
         if (is_save_file_name(filename))
         {
             try
             {
-                package save(_get_savedir_path(filename).c_str(), false);
-                player_save_info p = _read_character_info(&save);
+                const string path = _get_savedir_path(filename);
+                const save_info_record rec = _cached_save_info(path);
+                player_save_info p = _save_info_from_record(rec, path);
                 if (!p.name.empty())
                 {
                     p.filename = filename;
 #ifdef USE_TILE
-                    if (Options.tile_menu_icons && save.has_chunk("tdl"))
-                        _fill_player_doll(p, &save);
+                    if (Options.tile_menu_icons && rec.has_doll)
+                        _fill_player_doll(p, rec.doll_read ? &rec.doll
+                                                           : nullptr);
 #endif
                     chars.push_back(p);
                 }
@@ -861,15 +1088,24 @@ static bool _game_type_removed(const game_type g)
     return g == GAME_TYPE_ZOTDEF;
 }
 
+// If use_sidecar is set, filename must be in a save directory, and the save
+// info comes from its sidecar where possible.
 static bool _append_save_info(JsonWrapper &json, const char *filename,
-                                        game_type intended_gt=NUM_GAME_TYPE)
+                              game_type intended_gt=NUM_GAME_TYPE,
+                              bool use_sidecar = false)
 {
     if (!file_exists(filename))
         return false;
     try
     {
-        package save(filename, false);
-        player_save_info p = _read_character_info(&save);
+        player_save_info p;
+        if (use_sidecar)
+            p = _save_info_from_record(_cached_save_info(filename), filename);
+        else
+        {
+            package save(filename, false);
+            p = _read_character_info(&save);
+        }
 
         // TODO: some json for the non-loadable case? I think this comes up
         // for save compat mismatches so shouldn't be relevant for webtiles
@@ -927,7 +1163,8 @@ static bool _append_player_save_info(JsonWrapper &json, const char *name, game_t
     // requires init file to have been read, otherwise the correct savedir
     // paths may not have been initialized
     unwind_var<game_type> temp_gt(crawl_state.type, gt);
-    return _append_save_info(json, get_savedir_filename(name).c_str(), gt);
+    return _append_save_info(json, get_savedir_filename(name).c_str(), gt,
+                             true);
 }
 
 /**
@@ -1805,8 +2042,7 @@ bool generate_level(const level_id &l)
         // the level generated before the portals.
         ASSERT(you.save->has_chunk(save_name));
         dprf("Reloading new level '%s'.", save_name.c_str());
-        _restore_tagged_chunk(you.save, save_name, TAG_LEVEL,
-            "Level file is invalid.");
+        _restore_level_chunk(save_name, "Level file is invalid.");
     }
     // Did the generation process actually manage to place the player? This is
     // a useful sanity check, and also is necessary for the initial loading
@@ -2233,7 +2469,7 @@ bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
         }
 
         dprf("Loading old level '%s'.", level_name.c_str());
-        _restore_tagged_chunk(you.save, level_name, TAG_LEVEL, "Level file is invalid.");
+        _restore_level_chunk(level_name, "Level file is invalid.");
         if (load_mode != LOAD_VISITOR)
             you.on_current_level = true;
         _redraw_all(); // TODO why is there a redraw call here?
@@ -2552,6 +2788,175 @@ bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
     return just_created_level;
 }
 
+// Levels that were recently saved or loaded are also kept in memory, already
+// serialised but not compressed, so that stair-dancing and level excursions
+// don't have to go through zlib and the save package every time. A level that
+// already has a chunk in the package may be newer in memory than on disk
+// ("dirty"); such levels are written out when the package is committed, or
+// when they fall out of the cache. Levels with no chunk in the package yet
+// are always written through, so has_chunk() stays accurate.
+struct resident_level
+{
+    string name;
+    vector<unsigned char> data;
+    bool dirty;
+};
+
+// Most recently used first.
+static list<resident_level> resident_levels;
+static size_t resident_bytes = 0;
+// The package the cached levels belong to.
+static package *resident_owner = nullptr;
+
+static void _write_resident_level(const resident_level &lev)
+{
+    writer outf(you.save, lev.name);
+    outf.write(lev.data.data(), lev.data.size());
+}
+
+static void _trim_resident_levels()
+{
+    const size_t cap = size_t(max(0, Options.level_cache_size)) << 20;
+    while (resident_bytes > cap && !resident_levels.empty())
+    {
+        const resident_level &lev = resident_levels.back();
+        if (lev.dirty)
+            _write_resident_level(lev);
+        resident_bytes -= lev.data.size();
+        resident_levels.pop_back();
+    }
+}
+
+static list<resident_level>::iterator _find_resident_level(const string &name)
+{
+    if (resident_owner != you.save)
+        discard_resident_levels();
+    for (auto it = resident_levels.begin(); it != resident_levels.end(); ++it)
+        if (it->name == name)
+            return it;
+    return resident_levels.end();
+}
+
+static void _store_resident_level(const string &name,
+                                  vector<unsigned char> &&data, bool dirty)
+{
+    auto it = _find_resident_level(name);
+    if (it != resident_levels.end())
+    {
+        resident_bytes -= it->data.size();
+        resident_levels.erase(it);
+    }
+    resident_owner = you.save;
+    resident_bytes += data.size();
+    resident_levels.push_front({name, std::move(data), dirty});
+    _trim_resident_levels();
+}
+
+/**
+ * Write any levels that are newer in memory than in the save package out to
+ * the package. Called before the package is committed.
+ */
+void flush_resident_levels()
+{
+    if (!you.save || resident_owner != you.save)
+        return;
+    for (resident_level &lev : resident_levels)
+    {
+        if (lev.dirty)
+        {
+            _write_resident_level(lev);
+            lev.dirty = false;
+        }
+    }
+}
+
+/// Forget all cached levels without writing them out.
+void discard_resident_levels()
+{
+    resident_levels.clear();
+    resident_bytes = 0;
+    resident_owner = nullptr;
+}
+
+/**
+ * Is the resident level cache in use? If its size was set to 0 while levels
+ * were cached, they are written out and forgotten first, so that the package
+ * is left with the only (and newest) copy of each level.
+ */
+static bool _level_cache_enabled()
+{
+    if (Options.level_cache_size > 0)
+        return true;
+    if (resident_owner == you.save)
+        _trim_resident_levels();
+    else
+        discard_resident_levels();
+    return false;
+}
+
+/// An estimate of the memory held by the resident level cache.
+size_t resident_levels_memory()
+{
+    size_t total = 0;
+    for (const resident_level &lev : resident_levels)
+    {
+        // Each list node also holds two links.
+        total += sizeof(resident_level) + 2 * sizeof(void*)
+                 + mem_usage::string_bytes(lev.name)
+                 + mem_usage::vector_bytes(lev.data);
+    }
+    return total;
+}
+
+static void _drop_resident_level(const string &name)
+{
+    auto it = _find_resident_level(name);
+    if (it != resident_levels.end())
+    {
+        resident_bytes -= it->data.size();
+        resident_levels.erase(it);
+    }
+}
+
+/**
+ * Load a level chunk into env, from the resident cache if possible and from
+ * the save package otherwise.
+ */
+static void _restore_level_chunk(const string &name, const char* complaint)
+{
+    if (!_level_cache_enabled())
+    {
+        _restore_tagged_chunk(you.save, name, TAG_LEVEL, complaint);
+        return;
+    }
+
+    auto it = _find_resident_level(name);
+    if (it != resident_levels.end())
+        resident_levels.splice(resident_levels.begin(), resident_levels, it);
+    else
+    {
+        vector<char> raw;
+        {
+            chunk_reader cr(you.save, name);
+            cr.read_all(raw);
+        }
+        _store_resident_level(name,
+                              vector<unsigned char>(raw.begin(), raw.end()),
+                              false);
+        it = resident_levels.begin();
+    }
+
+    // The cache may have been trimmed to nothing by a tiny cap.
+    if (it == resident_levels.end() || it->name != name)
+    {
+        _restore_tagged_chunk(you.save, name, TAG_LEVEL, complaint);
+        return;
+    }
+
+    reader inf(it->data);
+    _restore_tagged_reader(inf, name, TAG_LEVEL, complaint);
+}
+
 void save_level(const level_id& lid)
 {
     if (you.level_visited(lid))
@@ -2563,7 +2968,27 @@ void save_level(const level_id& lid)
     // Nail all items to the ground.
     fix_item_coordinates();
 
-    _write_tagged_chunk(lid.describe(), TAG_LEVEL);
+    const string name = lid.describe();
+    if (!_level_cache_enabled())
+    {
+        _write_tagged_chunk(name, TAG_LEVEL);
+        return;
+    }
+
+    vector<unsigned char> data;
+    {
+        writer outf(&data);
+        write_save_version(outf, save_version::current());
+        tag_write(TAG_LEVEL, outf);
+    }
+
+    const bool defer = you.save->has_chunk(name);
+    if (!defer)
+    {
+        writer outf(you.save, name);
+        outf.write(data.data(), data.size());
+    }
+    _store_resident_level(name, std::move(data), defer);
 }
 
 #if TAG_MAJOR_VERSION == 34
@@ -2641,8 +3066,13 @@ static void _save_game_exit()
     tiles.send_exit_reason("saved");
 #endif
 
+    flush_resident_levels();
+    discard_resident_levels();
+    const string save_path = you.save->get_filename();
+    const save_info_record save_info = _make_save_info_record(*you.save);
     delete you.save;
     you.save = 0;
+    _update_save_info(save_path, save_info);
 }
 
 void save_game(bool leave_game, const char *farewellmsg)
@@ -2685,7 +3115,10 @@ void save_game(bool leave_game, const char *farewellmsg)
 #endif
         if (!crawl_state.disables[DIS_SAVE_CHECKPOINTS])
         {
+            flush_resident_levels();
             you.save->commit();
+            _update_save_info(you.save->get_filename(),
+                              _make_save_info_record(*you.save));
             save_game_prefs();
         }
         return;
@@ -3073,6 +3506,85 @@ static vector<ghost_demon> _load_permastore_ghosts(bool backup_on_upgrade=false)
     return _load_ghosts_core(_bones_permastore_file(), backup_on_upgrade);
 }
 
+/**
+ * Open a bones file and read its header, ready to read the ghost tag.
+ *
+ * @param inf   A reader for the bones file.
+ * @return      Whether the file is a readable bones file of a version we can
+ *              load. Anything else is left to load_bones_file() to deal with.
+ */
+static bool _open_bones_for_peek(reader &inf)
+{
+    if (!inf.valid())
+        return false;
+    inf.set_safe_read(true);
+    save_version version = read_ghost_header(inf);
+    if (!_ghost_version_compatible(version) || version.is_future())
+        return false;
+    inf.setMinorVersion(version.minor);
+    return true;
+}
+
+/**
+ * How many ghosts a bones file holds, without reading any of them.
+ *
+ * @return  The number of ghosts, or -1 if the file is missing or would need
+ *          the full load to sort out.
+ */
+static int _bones_ghost_count(const string &filename)
+{
+    reader inf(filename);
+    if (!_open_bones_for_peek(inf))
+        return -1;
+    try
+    {
+        return tag_read_ghost_count(inf);
+    }
+    catch (const short_read_exception&)
+    {
+    }
+    catch (const corrupted_save&)
+    {
+    }
+    return -1;
+}
+
+/**
+ * Read one random ghost from a bones file, without reading the ghosts after
+ * it.
+ *
+ * @param filename  The bones file.
+ * @param[out] ghost The ghost.
+ * @return          Whether a ghost was read. If not, the file is missing or
+ *                  needs the full load to sort out.
+ */
+static bool _sample_bones_file(const string &filename, ghost_demon &ghost)
+{
+    reader inf(filename);
+    if (!_open_bones_for_peek(inf))
+        return false;
+
+    vector<ghost_demon> sample;
+    try
+    {
+        sample.push_back(tag_read_random_ghost(inf));
+    }
+    catch (const short_read_exception&)
+    {
+        return false;
+    }
+    catch (const corrupted_save&)
+    {
+        return false;
+    }
+
+    string err_msg;
+    if (!debug_check_ghosts(sample, err_msg))
+        return false;
+    ghost = sample[0];
+    return true;
+}
+
 /**
  * Attempt to fill in a monster based on bones files.
  *
@@ -3082,6 +3594,9 @@ static vector<ghost_demon> _load_permastore_ghosts(bool backup_on_upgrade=false)
  */
 bool define_ghost_from_bones(monster& mons)
 {
+    if (replay::bones_disabled())
+        return false;
+
     rng::generator rng(rng::SYSTEM_SPECIFIC);
 
     bool used_permastore = false;
@@ -3089,7 +3604,14 @@ bool define_ghost_from_bones(monster& mons)
     vector<ghost_demon> loaded_ghosts = _load_ephemeral_ghosts();
     if (loaded_ghosts.empty())
     {
-        loaded_ghosts = _load_permastore_ghosts();
+        // The permastore isn't used up, so only the ghost we place needs
+        // reading. If it can't be sampled, the full load deals with whatever
+        // is wrong with it.
+        ghost_demon sample;
+        if (_sample_bones_file(_bones_permastore_file(), sample))
+            loaded_ghosts.push_back(sample);
+        else
+            loaded_ghosts = _load_permastore_ghosts();
         if (loaded_ghosts.empty())
             return false;
         used_permastore = true;
@@ -3238,6 +3760,7 @@ static bool _restore_game(const string& filename)
                   ).c_str(),
                   true, 'n'))
         {
+            delete_save_info(you.save->get_filename());
             you.save->unlink();
             you.save = 0;
             return false;
@@ -3380,7 +3903,10 @@ bool restore_game(const string& filename)
                   true, 'n'))
         {
             if (you.save)
+            {
+                delete_save_info(you.save->get_filename());
                 you.save->unlink();
+            }
             you.save = 0;
             return false;
         }
@@ -3420,7 +3946,10 @@ void delete_level(const level_id &level)
     clear_level_annotations(level);
 
     if (you.save)
+    {
+        _drop_resident_level(level.describe());
         you.save->delete_chunk(level.describe());
+    }
 
     auto &visited = you.props[VISITED_LEVELS_KEY].get_table();
     visited.erase(level.describe());
@@ -3646,7 +4175,13 @@ static bool _loadable_save_ver(int major, int minor)
 static player_save_info _read_character_info(package *save)
 {
     reader inf(save, "chr");
+    return _read_character_info(inf, save->get_filename());
+}
 
+// Read the character info from a "chr" chunk. filename is only for errors.
+static player_save_info _read_character_info(reader &inf,
+                                             const string &filename)
+{
     try
     {
         player_save_info result;
@@ -3656,7 +4191,7 @@ static player_save_info _read_character_info(package *save)
 
         unsigned int len = unmarshallInt(inf);
         if (len > 1024) // something is fishy
-            fail("Save file `%s` corrupted (info > 1KB)", save->get_filename().c_str());
+            fail("Save file `%s` corrupted (info > 1KB)", filename.c_str());
         vector<unsigned char> buf;
         buf.resize(len);
         inf.read(&buf[0], len);
@@ -3672,7 +4207,7 @@ static player_save_info _read_character_info(package *save)
         if (format > TAG_CHR_FORMAT)
         {
             fail("Incompatible character data from the future in `%s`",
-                                        save->get_filename().c_str());
+                                        filename.c_str());
         }
 
         result = tag_read_char_info(th, format, major, minor);
@@ -3687,7 +4222,7 @@ static player_save_info _read_character_info(package *save)
     }
     catch (const short_read_exception &)
     {
-        fail("Save file `%s` corrupted (short read)", save->get_filename().c_str());
+        fail("Save file `%s` corrupted (short read)", filename.c_str());
     };
 }
 
@@ -3744,6 +4279,12 @@ static bool _restore_tagged_chunk(package *save, const string &name,
                                   tag_type tag, const char* complaint)
 {
     reader inf(save, name);
+    return _restore_tagged_reader(inf, name, tag, complaint);
+}
+
+static bool _restore_tagged_reader(reader &inf, const string &name,
+                                   tag_type tag, const char* complaint)
+{
     string reason;
     if (!_tagged_chunk_version_compatible(inf, &reason))
     {
@@ -3828,19 +4369,72 @@ static size_t _ghost_permastore_size()
         return GHOST_PERMASTORE_SIZE * 2;
 }
 
+/**
+ * Write a ghost permastore, replacing any existing one in a single step, so
+ * that a concurrent reader sees either the old store or the new one.
+ *
+ * @return  Whether the store was written.
+ */
+static bool _write_permastore(const string &permastore_file,
+                              const vector<ghost_demon> &permastore)
+{
+    // Updaters hold the store's .lk lock, so the temp file is ours alone; a
+    // stale one left by a crashed process is just overwritten.
+    const string temp_file = permastore_file + ".tmp";
+    FILE *ghost_file = lk_open("wb", temp_file);
+    if (!ghost_file)
+    {
+        _ghost_dprf("Could not open ghost permastore: %s", temp_file.c_str());
+        return false;
+    }
+
+    _ghost_dprf("Rewriting ghost permastore %s with %u ghosts",
+                permastore_file.c_str(), (unsigned int) permastore.size());
+    bool ok;
+    {
+        writer outw(temp_file, ghost_file, true);
+        write_ghost_version(outw);
+        tag_write_ghosts(outw, permastore);
+        ok = outw.succeeded();
+    }
+    lk_close(ghost_file);
+
+    if (ok && !rename_u(temp_file.c_str(), permastore_file.c_str()))
+        return true;
+
+    mprf(MSGCH_ERROR, "Error writing ghost permastore %s",
+         permastore_file.c_str());
+    unlink_u(temp_file.c_str());
+    return false;
+}
+
 static vector<ghost_demon> _update_permastore(const vector<ghost_demon> &ghosts)
 {
     rng::generator rng(rng::SYSTEM_SPECIFIC);
     if (ghosts.empty())
         return ghosts;
 
-    // this read is not locked...
+    string permastore_file = _bones_permastore_file();
+    if (permastore_file.empty()) // this level has no permastore
+        return ghosts;
+    const size_t max_ghosts = _ghost_permastore_size();
+
+    // A full store is only rewritten to replace a ghost occasionally, so
+    // check that before reading it all in.
+    const int stored = _bones_ghost_count(permastore_file);
+    const bool replace = x_chance_in_y(GHOST_PERMASTORE_REPLACE_CHANCE, 100);
+    if (stored >= (int) max_ghosts && !replace)
+        return ghosts;
+
+    // Serialise updates to the store, so that one doesn't undo another.
+    // Readers don't take this; the store is only ever replaced whole.
+    file_lock store_lock(permastore_file + ".lk", "wb", false);
+
     vector<ghost_demon> permastore = _load_permastore_ghosts();
     vector<ghost_demon> leftovers;
 
     bool rewrite = false;
     unsigned int i = 0;
-    const size_t max_ghosts = _ghost_permastore_size();
     while (permastore.size() < max_ghosts && i < ghosts.size())
     {
         // TODO: heuristics to make this as distinct as possible; maybe
@@ -3855,8 +4449,7 @@ static vector<ghost_demon> _update_permastore(const vector<ghost_demon> &ghosts)
     }
     if (i > 0)
         _ghost_dprf("Permastoring %d ghosts", i);
-    if (!rewrite && x_chance_in_y(GHOST_PERMASTORE_REPLACE_CHANCE, 100)
-                                                        && i < ghosts.size())
+    if (!rewrite && replace && i < ghosts.size())
     {
         int rewrite_i = random2(permastore.size());
         permastore[rewrite_i] = ghosts[i];
@@ -3873,8 +4466,6 @@ static vector<ghost_demon> _update_permastore(const vector<ghost_demon> &ghosts)
 
     if (rewrite)
     {
-        string permastore_file = _bones_permastore_file();
-
         // the following is to ensure that an old game doesn't overwrite a
         // permastore that has a version in the future relative to that game.
         {
@@ -3892,24 +4483,8 @@ static vector<ghost_demon> _update_permastore(const vector<ghost_demon> &ghosts)
             }
         }
 
-        FILE *ghost_file = lk_open("wb", permastore_file);
-
-        if (!ghost_file)
-        {
-            // this will fail silently if the lock fails, seems safest
-            // TODO: better lock system for servers?
-            _ghost_dprf("Could not open ghost permastore: %s",
-                                                    permastore_file.c_str());
+        if (!_write_permastore(permastore_file, permastore))
             return ghosts;
-        }
-
-        _ghost_dprf("Rewriting ghost permastore %s with %u ghosts",
-                    permastore_file.c_str(), (unsigned int) permastore.size());
-        writer outw(permastore_file, ghost_file);
-        write_ghost_version(outw);
-        tag_write_ghosts(outw, permastore);
-
-        lk_close(ghost_file);
     }
     return leftovers;
 }
@@ -3928,6 +4503,11 @@ void save_ghosts(const vector<ghost_demon> &ghosts, bool force, bool use_store)
     // chars, so for debugging anything to do with deaths in wizmode, you will
     // need to edit a conditional at the end of ouch.cc:ouch.
     _ghost_dprf("Trying to save ghosts.");
+    if (replay::replaying())
+    {
+        _ghost_dprf("Not saving ghosts from a replay.");
+        return;
+    }
     if (ghosts.empty())
     {
         _ghost_dprf("Could not find any ghosts for this level to save.");
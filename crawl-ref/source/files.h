@@ -98,6 +98,9 @@ bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
                 const level_id& old_level);
 void delete_level(const level_id &level);
 void save_level(const level_id& lid);
+void flush_resident_levels();
+void discard_resident_levels();
+size_t resident_levels_memory();
 
 void save_game(bool leave_game, const char *bye = nullptr);
 
@@ -108,6 +111,7 @@ void write_save_version(writer &file, save_version version);
 save_version get_save_version(reader &file);
 
 bool save_exists(const string& filename);
+void delete_save_info(const string &save_path);
 bool restore_game(const string& filename);
 
 bool is_existing_level(const level_id &level);
@@ -67,14 +67,16 @@ using namespace ui;
 
 #define SCORE_VERSION "0.1"
 
-// enough memory allocated to snarf in the scorefile entries
-static unique_ptr<scorefile_entry> hs_list[SCORE_FILE_ENTRIES];
-static int hs_list_size = 0;
+// The scorefile as last read or written: its raw lines, in order, and the
+// entries parsed from them. Lines are only parsed when an entry is needed.
+static vector<string> hs_lines;
+static vector<unique_ptr<scorefile_entry>> hs_list;
 static bool hs_list_initialized = false;
 
 static FILE *_hs_open(const char *mode, const string &filename);
 static void  _hs_close(FILE *handle);
 static bool  _hs_read(FILE *scores, scorefile_entry &dest);
+static bool  _hs_read_line(FILE *scores, string &line);
 static void  _hs_write(FILE *scores, scorefile_entry &entry);
 static time_t _parse_time(const string &st);
 static string _xlog_escape(const string &s);
@@ -103,92 +105,120 @@ static string _log_file_name(bool milestones=false)
         + crawl_state.game_type_qualifier());
 }
 
+// Read up to SCORE_FILE_ENTRIES raw lines from the scorefile. Stops at the
+// first line that isn't a score. If offsets is given, it gets the offset at
+// which each line starts, followed by the offset just past the last one.
+static void _hs_read_lines(FILE *scores, vector<string> &lines,
+                           vector<long> *offsets = nullptr)
+{
+    lines.clear();
+    if (offsets)
+        offsets->assign(1, ftell(scores));
+
+    string line;
+    while (lines.size() < SCORE_FILE_ENTRIES)
+    {
+        if (!_hs_read_line(scores, line) || line[0] == ':')
+            break;
+        lines.push_back(line);
+        if (offsets)
+            offsets->push_back(ftell(scores));
+    }
+}
+
+static void _hs_set_lines(vector<string> &&lines)
+{
+    hs_lines = std::move(lines);
+    hs_list.clear();
+    hs_list.resize(hs_lines.size());
+    hs_list_initialized = true;
+}
+
+// The entry for the i'th line of the cached scorefile, parsed on demand.
+static scorefile_entry &_hs_entry(int i)
+{
+    if (!hs_list[i])
+    {
+        hs_list[i].reset(new scorefile_entry);
+        hs_list[i]->parse(hs_lines[i]);
+    }
+    return *hs_list[i];
+}
+
+// Just the score from a scorefile line, without the cost of building the
+// whole entry.
+static int _hs_line_score(const string &line)
+{
+    return xlog_fields(line).int_field("sc");
+}
+
 int hiscores_new_entry(const scorefile_entry &ne)
 {
     unwind_bool score_update(crawl_state.updating_scores, true);
 
-    FILE *scores;
-    int i;
-    bool inserted = false;
-    int newest_entry = -1;
-
     // open highscore file (reading) -- nullptr is fatal!
     //
     // Opening as a+ instead of r+ to force an exclusive lock (see
     // hs_open) and to create the file if it's not there already.
-    scores = _hs_open("a+", _score_file_name());
+    FILE *scores = _hs_open("a+", _score_file_name());
     if (scores == nullptr)
         end(1, true, "failed to open score file for writing");
 
     // we're at the end of the file, seek back to beginning.
     fseek(scores, 0, SEEK_SET);
 
-    // read highscore file, inserting new entry at appropriate point,
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
-    {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
-
-        // compare points..
-        if (!inserted && ne.get_score() >= hs_list[i]->get_score())
-        {
-            newest_entry = i;           // for later printing
-            inserted = true;
-            // copy read entry to i+1th position
-            // Fixed a nasty overflow bug here -- Sharp
-            if (i+1 < SCORE_FILE_ENTRIES)
-            {
-                hs_list[i + 1] = std::move(hs_list[i]);
-                hs_list[i].reset(new scorefile_entry(ne));
-                i++;
-            }
-            else
-                *hs_list[i] = ne; // copy new entry to current position
-        }
-    }
-
-    // special case: lowest score, with room
-    if (!inserted && i < SCORE_FILE_ENTRIES)
-    {
-        newest_entry = i;
-        inserted = true;
-        // copy new entry
-        hs_list[i].reset(new scorefile_entry(ne));
-        i++;
-    }
+    vector<string> lines;
+    vector<long> offsets;
+    _hs_read_lines(scores, lines, &offsets);
 
-    hs_list_size = i;
-    hs_list_initialized = true;
+    // The file is kept sorted by score, highest first, so binary search for
+    // the first entry the new one ties or beats. Only the scores of the
+    // lines probed get parsed.
+    const int score = ne.get_score();
+    const int newest_entry = partition_point(lines.begin(), lines.end(),
+        [score](const string &line) { return score < _hs_line_score(line); })
+        - lines.begin();
 
-    // If we've still not inserted it, it's not a highscore.
-    if (!inserted)
+    // If there's no room for it, it's not a highscore.
+    if (newest_entry >= SCORE_FILE_ENTRIES)
     {
         _hs_close(scores);
+        _hs_set_lines(std::move(lines));
         return -1;
     }
 
     // The old code closed and reopened the score file, leading to a
     // race condition where one Crawl process could overwrite the
     // other's highscore. Now we truncate and rewrite the file without
-    // closing it.
-    if (ftruncate(fileno(scores), 0))
+    // closing it. Everything before the new entry stays as it is, so only
+    // the entries after it need to be rewritten; a new lowest score is
+    // just appended.
+    if (ftruncate(fileno(scores), offsets[newest_entry]))
         end(1, true, "unable to truncate scorefile");
+    // Switching from reading to writing needs a seek in between.
+    fseek(scores, 0, SEEK_END);
 
-    rewind(scores);
-
-    // write scorefile entries.
-    for (i = 0; i < hs_list_size; i++)
+    // If the file now ends in a line cut short, say by a crash partway
+    // through writing it, end that line so the new entries don't join it.
+    if (newest_entry > 0 && lines[newest_entry - 1].back() != '\n')
     {
-        _hs_write(scores, *hs_list[i]);
-
-        // Leave in memory. Does this anyway if !inserted.
-        // Can write cleanup function if nessicary??
-        // hs_list[i].reset(nullptr);
+        lines[newest_entry - 1] += '\n';
+        fputc('\n', scores);
     }
 
+    lines.insert(lines.begin() + newest_entry, ne.raw_string());
+    if (lines.size() > SCORE_FILE_ENTRIES)
+        lines.pop_back();
+
+    // In append mode, these writes all go to the new end of the file.
+    for (size_t i = newest_entry; i < lines.size(); i++)
+        fprintf(scores, "%s", lines[i].c_str());
+
     // close scorefile.
     _hs_close(scores);
+
+    _hs_set_lines(std::move(lines));
+    hs_list[newest_entry].reset(new scorefile_entry(ne));
     return newest_entry;
 }
 
@@ -237,27 +267,19 @@ static void _hiscores_print_entry(const scorefile_entry &se,
 // Reads hiscores file to memory
 void hiscores_read_to_memory()
 {
-    FILE *scores;
-    int i;
-
     // open highscore file (reading)
-    scores = _hs_open("r", _score_file_name());
+    FILE *scores = _hs_open("r", _score_file_name());
     if (scores == nullptr)
         return;
 
-    // read highscore file
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
-    {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
-    }
-
-    hs_list_size = i;
-    hs_list_initialized = true;
+    // Entries are only parsed when they're displayed.
+    vector<string> lines;
+    _hs_read_lines(scores, lines);
 
     //close off
     _hs_close(scores);
+
+    _hs_set_lines(std::move(lines));
 }
 
 // Writes all entries in the scorefile to stdout in human-readable form.
@@ -304,7 +326,7 @@ string hiscores_print_list(int display_count, int format, int newest_entry, int&
     if (display_count <= 0)
         return "";
 
-    total_entries = hs_list_size;
+    total_entries = hs_lines.size();
 
     int start = newest_entry - display_count / 2;
 
@@ -322,7 +344,7 @@ string hiscores_print_list(int display_count, int format, int newest_entry, int&
         if (i == newest_entry)
             ret += "<yellow>";
 
-        _hiscores_print_entry(*hs_list[i], i, format, [&ret](const char */*fmt*/, const char *s){
+        _hiscores_print_entry(_hs_entry(i), i, format, [&ret](const char */*fmt*/, const char *s){
             ret += string(s);
         });
 
@@ -461,24 +483,10 @@ UIHiscoresMenu::UIHiscoresMenu()
 
 void UIHiscoresMenu::_construct_hiscore_table()
 {
-    FILE *scores = _hs_open("r", _score_file_name());
+    hiscores_read_to_memory();
 
-    if (scores == nullptr)
-        return;
-
-    int i;
-    // read highscore file
-    for (i = 0; i < SCORE_FILE_ENTRIES; i++)
-    {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
-            break;
-    }
-
-    _hs_close(scores);
-
-    for (int j=0; j<i; j++)
-        _add_hiscore_row(*hs_list[j], j);
+    for (int j = 0; j < (int) hs_lines.size(); j++)
+        _add_hiscore_row(_hs_entry(j), j);
 }
 
 void UIHiscoresMenu::_add_hiscore_row(scorefile_entry& se, int id)
@@ -490,7 +498,7 @@ void UIHiscoresMenu::_add_hiscore_row(scorefile_entry& se, int id)
     tmp->set_margin_for_sdl(2);
     btn->set_child(std::move(tmp));
     btn->on_activate_event([id](const ActivateEvent&) {
-        _show_morgue(*hs_list[id]);
+        _show_morgue(_hs_entry(id));
         return true;
     });
     btn->on_focusin_event([this, se](const FocusEvent&) {
@@ -610,19 +618,32 @@ static void _hs_close(FILE *handle)
     lk_close(handle);
 }
 
-static bool _hs_read(FILE *scores, scorefile_entry &dest)
+// Read one line, including its newline (if any).
+static bool _hs_read_line(FILE *scores, string &line)
 {
     char inbuf[1500];
+    line.clear();
     if (!scores || feof(scores))
         return false;
 
-    memset(inbuf, 0, sizeof inbuf);
+    while (fgets(inbuf, sizeof inbuf, scores))
+    {
+        line += inbuf;
+        if (line.back() == '\n')
+            break;
+    }
+    return !line.empty();
+}
+
+static bool _hs_read(FILE *scores, scorefile_entry &dest)
+{
+    string line;
     dest.reset();
 
-    if (!fgets(inbuf, sizeof inbuf, scores))
+    if (!_hs_read_line(scores, line))
         return false;
 
-    return dest.parse(inbuf);
+    return dest.parse(line);
 }
 
 static int _val_char(char digit)
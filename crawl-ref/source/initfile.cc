@@ -26,6 +26,7 @@
 #include <string>
 
 #include "ability.h"
+#include "arena.h"
 #include "branch-data-json.h"
 #include "chardump.h"
 #include "clua.h"
@@ -53,6 +54,7 @@
 #include "macro.h"
 #include "mapdef.h"
 #include "maps.h"
+#include "mem-usage.h"
 #include "message.h"
 #include "mon-util.h"
 #include "monster.h"
@@ -60,7 +62,9 @@
 #include "options.h"
 #include "playable.h"
 #include "player.h"
+#include "profiler.h"
 #include "prompt.h"
+#include "replay.h"
 #include "slot-select-mode.h"
 #include "species.h"
 #include "spl-util.h"
@@ -78,6 +82,7 @@
 #include "viewchar.h"
 #include "view.h"
 #include "wizard-option-type.h"
+#include "zygote.h"
 #ifdef USE_TILE
 #include "tilepick.h"
 #include "rltiles/tiledef-player.h"
@@ -668,6 +673,7 @@ const vector<GameOption*> game_options::build_options_list()
         new IntGameOption(SIMPLE_NAME(rest_wait_percent), 100, 0, 100),
         new IntGameOption(SIMPLE_NAME(pickup_menu_limit), 1),
         new IntGameOption(SIMPLE_NAME(view_delay), DEFAULT_VIEW_DELAY, 0),
+        new IntGameOption(SIMPLE_NAME(level_cache_size), 32, 0, 1024),
         new IntGameOption(SIMPLE_NAME(fail_severity_to_confirm), 3, -1, 5),
         new IntGameOption(SIMPLE_NAME(fail_severity_to_quiver), 3, -1, 5),
         new IntGameOption(SIMPLE_NAME(travel_delay), USING_DGL ? -1 : 20,
@@ -1010,6 +1016,7 @@ const vector<GameOption*> game_options::build_options_list()
         new StringGameOption(SIMPLE_NAME(fsim_mode), ""),
         new StringGameOption(SIMPLE_NAME(fsim_mons), ""),
         new IntGameOption(SIMPLE_NAME(fsim_rounds), 4000, 1000, 500000),
+        new IntGameOption(SIMPLE_NAME(fsim_jobs), 1, 1, 64),
 #endif
 #if !defined(DGAMELAUNCH) || defined(DGL_REMEMBER_NAME)
         new BoolGameOption(SIMPLE_NAME(remember_name), true),
@@ -1020,10 +1027,11 @@ const vector<GameOption*> game_options::build_options_list()
     return options;
 }
 
-map<string, GameOption*> base_game_options::build_options_map(
+unordered_map<string, GameOption*> base_game_options::build_options_map(
     const vector<GameOption*> &options)
 {
-    map<string, GameOption*> option_map;
+    unordered_map<string, GameOption*> option_map;
+    option_map.reserve(options.size());
     for (GameOption* option : options)
         for (string name : option->getNames())
             option_map[name] = option;
@@ -2372,15 +2380,12 @@ void read_init_file(bool runscripts)
     }
 #endif
 
-    FileLineInput f(init_file_name.c_str());
-
     Options.filename = init_file_name;
     Options.basefilename = base_file_name;
     Options.line_num = 0;
 
-    if (f.error())
+    if (!Options.read_options_file(init_file_name, runscripts))
         return;
-    Options.read_options(f, runscripts);
 
     if (Options.read_persist_options)
     {
@@ -3717,55 +3722,61 @@ static bool _is_autopickup_ban(pair<text_pattern, bool> entry)
     return !entry.second;
 }
 
+static bool _is_rc_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
 opt_parse_state base_game_options::parse_option_line(const string &str)
 {
     opt_parse_state state;
 
-    const int first_equals = str.find('=');
+    const string::size_type first_equals = str.find('=');
 
     // all lines with no equal-signs we ignore
-    if (first_equals < 0)
+    if (first_equals == string::npos)
         return state;
 
     state.raw = str;
-    state.field = str.substr(first_equals + 1);
-    state.field = expand_vars(state.field);
 
-    string prequal = trimmed_string(str.substr(0, first_equals));
+    // Find the key and any operator before the '=' in place, rather than
+    // trimming copies of the line.
+    string::size_type key_begin = 0;
+    string::size_type key_end = first_equals;
+    while (key_begin < key_end && _is_rc_space(str[key_begin]))
+        key_begin++;
+    while (key_end > key_begin && _is_rc_space(str[key_end - 1]))
+        key_end--;
 
-    // Is this a case of key += val?
-    if (prequal.length() && prequal[prequal.length() - 1] == '+')
+    const char op = key_end > key_begin ? str[key_end - 1] : 0;
+    if (op == '+' || op == '-' || op == '^' || op == ':')
     {
-        state.line_type = RCFILE_LINE_PLUS;
-        prequal = prequal.substr(0, prequal.length() - 1);
-        trim_string(prequal);
+        key_end--;
+        while (key_end > key_begin && _is_rc_space(str[key_end - 1]))
+            key_end--;
     }
-    else if (prequal.length() && prequal[prequal.length() - 1] == '-')
-    {
+
+    state.field = str.substr(first_equals + 1);
+    if (state.field.find('$') != string::npos)
+        state.field = expand_vars(state.field);
+    trim_string(state.field);
+
+    if (op == '+')
+        state.line_type = RCFILE_LINE_PLUS;
+    else if (op == '-')
         state.line_type = RCFILE_LINE_MINUS;
-        prequal = prequal.substr(0, prequal.length() - 1);
-        trim_string(prequal);
-    }
-    else if (prequal.length() && prequal[prequal.length() - 1] == '^')
-    {
+    else if (op == '^')
         state.line_type = RCFILE_LINE_CARET;
-        prequal = prequal.substr(0, prequal.length() - 1);
-        trim_string(prequal);
-    }
-    else if (prequal.length() && prequal[prequal.length() - 1] == ':')
+    else if (op == ':')
     {
-        prequal = prequal.substr(0, prequal.length() - 1);
-        trim_string(prequal);
-        trim_string(state.field);
-
-        add_alias(prequal, state.field);
+        add_alias(str.substr(key_begin, key_end - key_begin), state.field);
         state.line_type = RCFILE_LINE_DIRECTIVE;
         // done, no need for further parsing
         state.valid = true;
         return state;
     }
 
-    prequal = unalias(prequal);
+    const string prequal = unalias(str.substr(key_begin, key_end - key_begin));
 
     const string::size_type first_dot = prequal.find('.');
     if (first_dot != string::npos)
@@ -3783,9 +3794,6 @@ opt_parse_state base_game_options::parse_option_line(const string &str)
     lowercase(trim_string(state.key));
     lowercase(trim_string(state.subkey));
 
-    // some fields want capitals... none care about external spaces
-    trim_string(state.field);
-
     // Keep cased version of `field`, some options need it
     state.raw_field = state.field;
     lowercase(state.field);
@@ -4685,6 +4693,95 @@ bool base_game_options::was_included(const string &file) const
     return included.count(file);
 }
 
+// The lines of an options file as last read, with its modification time.
+// Every game start reads the options files at least twice, and unchanged
+// files needn't be decoded again.
+struct options_file_lines
+{
+    time_t mtime;
+    shared_ptr<const vector<string>> lines;
+};
+
+static map<string, options_file_lines> options_file_cache;
+
+class CachedLineInput : public LineInput
+{
+public:
+    CachedLineInput(shared_ptr<const vector<string>> l)
+        : lines(std::move(l)), pos(0)
+    {
+    }
+
+    bool eof() override { return pos >= lines->size(); }
+    string get_line() override { return eof() ? "" : (*lines)[pos++]; }
+
+private:
+    shared_ptr<const vector<string>> lines;
+    size_t pos;
+};
+
+// The lines of an options file, or nullptr if it can't be read.
+static shared_ptr<const vector<string>> _options_file_lines(const string &file)
+{
+    const time_t mtime = file_modtime(file);
+    auto cached = options_file_cache.find(file);
+    if (cached != options_file_cache.end() && mtime
+        && cached->second.mtime == mtime)
+    {
+        profiler::count(PROF_COUNTER, "options files reread from cache");
+        return cached->second.lines;
+    }
+
+    FileLineInput fl(file.c_str());
+    if (fl.error())
+    {
+        options_file_cache.erase(file);
+        return nullptr;
+    }
+
+    auto lines = make_shared<vector<string>>();
+    while (!fl.eof())
+        lines->push_back(fl.get_line());
+    options_file_cache[file] = { mtime, lines };
+    return lines;
+}
+
+size_t options_file_cache_memory()
+{
+    size_t total = mem_usage::map_bytes(options_file_cache);
+    for (const auto &entry : options_file_cache)
+    {
+        total += mem_usage::string_bytes(entry.first)
+                 + sizeof(vector<string>)
+                 + mem_usage::vector_bytes(*entry.second.lines);
+        for (const string &line : *entry.second.lines)
+            total += mem_usage::string_bytes(line);
+    }
+    return total;
+}
+
+void clear_options_file_cache()
+{
+    options_file_cache.clear();
+}
+
+// Read options from a file, timing it (with whatever it includes) under its
+// base name. Returns false if the file can't be read.
+bool base_game_options::read_options_file(const string &file, bool runscripts,
+                                          bool clear_aliases)
+{
+    auto lines = _options_file_lines(file);
+    if (!lines)
+        return false;
+
+    // The timer keeps the name until the end of the scope.
+    const string prof_name = get_base_filename(file);
+    PROF_SCOPE(PROF_OPTIONS_FILE, prof_name.c_str());
+    CachedLineInput input(lines);
+    read_options(input, runscripts, clear_aliases);
+    return true;
+}
+
 void base_game_options::include(const string &rawfilename, bool resolve,
                            bool runscripts)
 {
@@ -4706,9 +4803,7 @@ void base_game_options::include(const string &rawfilename, bool resolve,
     // Also unwind any aliases defined in included files.
     unwind_var<map<string, string>> unalias(aliases);
 
-    FileLineInput fl(include_file.c_str());
-    if (!fl.error())
-        read_options(fl, runscripts, false);
+    read_options_file(include_file, runscripts, false);
 }
 
 void base_game_options::report_error(const char* format, ...)
@@ -4861,8 +4956,17 @@ enum commandline_option_type
     CLO_WEBTILES_SOCKET,
     CLO_AWAIT_CONNECTION,
     CLO_PRINT_WEBTILES_OPTIONS,
+    CLO_ZYGOTE,
 #endif
     CLO_RESET_CACHE,
+    CLO_TURN_PROFILE,
+    CLO_MEMORY_SOFT_LIMIT,
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+    CLO_RECORD_KEYS,
+    CLO_REPLAY,
+    CLO_ARENA_BATCH,
+    CLO_ARENA_JOBS,
+#endif
 
     CLO_NOPS
 };
@@ -4889,6 +4993,11 @@ static set<commandline_option_type> clo_headless_ok = {
     CLO_ARENA,
     CLO_TEST,
     CLO_SCRIPT,
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+    CLO_REPLAY,
+    CLO_ARENA_BATCH,
+    CLO_ARENA_JOBS,
+#endif
 #ifdef USE_TILE_WEB
     CLO_WEBTILES_SOCKET,
     CLO_AWAIT_CONNECTION,
@@ -4915,8 +5024,12 @@ static const char *cmd_ops[] =
 #endif
 #ifdef USE_TILE_WEB
     "webtiles-socket", "await-connection", "print-webtiles-options",
+    "zygote",
+#endif
+    "reset-cache", "turn-profile", "memory-soft-limit",
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+    "record-keys", "replay", "arena-batch", "arena-jobs",
 #endif
-    "reset-cache",
 };
 
 
@@ -6214,6 +6327,64 @@ bool parse_args(int argc, char **argv, bool rc_only)
                 Options.no_player_bones = true;
             break;
 
+        case CLO_TURN_PROFILE:
+            if (!next_is_param)
+                return false;
+            // Switch on early enough to time the options files.
+            profiler::enabled = true;
+            if (!rc_only)
+                profiler::output_file = next_arg;
+            nextUsed = true;
+            break;
+
+        case CLO_MEMORY_SOFT_LIMIT:
+            if (!next_is_param)
+                return false;
+
+            if (!sscanf(next_arg, "%" SCNu64, &mem_usage::soft_limit_mb))
+                return false;
+            nextUsed = true;
+            break;
+
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+        case CLO_RECORD_KEYS:
+            if (!next_is_param)
+                return false;
+            if (!rc_only)
+                replay::record_file = next_arg;
+            nextUsed = true;
+            break;
+
+        case CLO_REPLAY:
+            if (!next_is_param)
+                return false;
+            enter_headless_mode();
+            replay::replay_file = next_arg;
+            replay::load(rc_only);
+            nextUsed = true;
+            break;
+
+        case CLO_ARENA_BATCH:
+            if (!next_is_param)
+                return false;
+            enter_headless_mode();
+            if (!rc_only)
+            {
+                Options.game.type = GAME_TYPE_ARENA;
+                Options.restart_after_game = false;
+                arena::batch_file = next_arg;
+            }
+            nextUsed = true;
+            break;
+
+        case CLO_ARENA_JOBS:
+            if (!next_is_param || !isadigit(*next_arg))
+                end(1, false, "Integer argument required for -%s\n", arg);
+            arena::batch_jobs = min(max(atoi(next_arg), 1), 64);
+            nextUsed = true;
+            break;
+#endif
+
 #ifdef USE_TILE_WEB
         case CLO_WEBTILES_SOCKET:
             nextUsed          = true;
@@ -6231,6 +6402,13 @@ bool parse_args(int argc, char **argv, bool rc_only)
                 end(0);
             }
             break;
+
+        case CLO_ZYGOTE:
+            if (!next_is_param)
+                return false;
+            zygote::socket_path = next_arg;
+            nextUsed = true;
+            break;
 #endif
 
         case CLO_PRINT_CHARSET:
@@ -24,6 +24,10 @@ job_type str_to_job(const string &str);
 
 string find_crawlrc();
 void read_init_file(bool runscript = false);
+// The memory held by the cached contents of options files, and a way to
+// drop them.
+size_t options_file_cache_memory();
+void clear_options_file_cache();
 
 struct newgame_def;
 newgame_def read_startup_prefs();
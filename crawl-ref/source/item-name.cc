@@ -3670,12 +3670,14 @@ static item_names_map item_names_cache;
 
 typedef map<unsigned, vector<string> > item_names_by_glyph_map;
 static item_names_by_glyph_map item_names_by_glyph_cache;
+// The glyph index depends on the character set and item_glyph options, so is
+// rebuilt whenever those might have changed; the names never change.
+static bool item_glyph_cache_stale = true;
 
-void init_item_name_cache()
+// Call f(name, kind, item, removed) for every nameable item kind.
+template <typename F>
+static void _for_each_item_name(F f)
 {
-    item_names_cache.clear();
-    item_names_by_glyph_cache.clear();
-
     for (int i = 0; i < NUM_OBJECT_CLASSES; i++)
     {
         const object_class_type base_type = static_cast<object_class_type>(i);
@@ -3703,7 +3705,6 @@ void init_item_name_cache()
                 string name = item.name(plus || item.base_type == OBJ_RUNES ? DESC_PLAIN : DESC_DBNAME,
                                         true, true);
                 lowercase(name);
-                cglyph_t g = get_item_glyph(item);
 
                 if (base_type == OBJ_JEWELLERY && sub_type >= NUM_RINGS
                     && sub_type < AMU_FIRST_AMULET)
@@ -3720,33 +3721,73 @@ void init_item_name_cache()
                     || base_type == OBJ_BOOKS && sub_type == BOOK_MANUAL
                         && is_removed_skill(static_cast<skill_type>(item.plus));
 
-                if (!item_names_cache.count(name))
-                {
-                    // what would happen if we don't put removed items in the
-                    // item name cache?
-                    item_names_cache[name] = { base_type, (uint8_t)sub_type,
-                                               (int8_t)item.plus, 0 };
-
-                    // only used for help lookup, skip removed items
-                    if (g.ch && !removed)
-                        item_names_by_glyph_cache[g.ch].push_back(name);
-                }
+                f(name, item_kind{ base_type, (uint8_t)sub_type,
+                                   (int8_t)item.plus, 0 },
+                  item, removed);
             }
         }
     }
+}
+
+static const item_names_map &_item_names()
+{
+    if (item_names_cache.empty())
+    {
+        _for_each_item_name([](const string &name, const item_kind &kind,
+                               const item_def &, bool)
+        {
+            // what would happen if we don't put removed items in the
+            // item name cache?
+            if (!item_names_cache.count(name))
+                item_names_cache[name] = kind;
+        });
+        ASSERT(!item_names_cache.empty());
+    }
+    return item_names_cache;
+}
+
+static const item_names_by_glyph_map &_item_names_by_glyph()
+{
+    if (item_glyph_cache_stale)
+    {
+        item_names_by_glyph_cache.clear();
+        set<string> seen;
+        _for_each_item_name([&seen](const string &name, const item_kind &,
+                                    const item_def &item, bool removed)
+        {
+            // Only the first item with a given name is indexed, as in the
+            // name cache. Skip removed items: this is only used for help
+            // lookup.
+            if (!seen.insert(name).second)
+                return;
+            const cglyph_t g = get_item_glyph(item);
+            if (g.ch && !removed)
+                item_names_by_glyph_cache[g.ch].push_back(name);
+        });
+        item_glyph_cache_stale = false;
+    }
+    return item_names_by_glyph_cache;
+}
 
-    ASSERT(!item_names_cache.empty());
+/**
+ * Note that item glyphs may have changed (a new character set or item_glyph
+ * options). The name lookup tables themselves are built on first use, rather
+ * than at startup, since most runs need few or none of them.
+ */
+void init_item_name_cache()
+{
+    item_glyph_cache_stale = true;
 }
 
 item_kind item_kind_by_name(const string &name)
 {
-    return lookup(item_names_cache, lowercase_string(name),
+    return lookup(_item_names(), lowercase_string(name),
                   { OBJ_UNASSIGNED, 0, 0, 0 });
 }
 
 vector<string> item_name_list_for_glyph(char32_t glyph)
 {
-    return lookup(item_names_by_glyph_cache, glyph, {});
+    return lookup(_item_names_by_glyph(), glyph, {});
 }
 
 bool is_named_corpse(const item_def &corpse)
@@ -35,6 +35,7 @@
 #include "cio.h"
 #include "crash.h"
 #include "libutil.h"
+#include "replay.h"
 #include "state.h"
 #include "tiles-build-specific.h"
 #include "unicode.h"
@@ -633,7 +634,7 @@ static int _headless_getch_ck()
     return c;
 }
 
-int getch_ck()
+static int _getch_ck()
 {
     if (_headless_mode)
         return _headless_getch_ck();
@@ -733,6 +734,13 @@ int getch_ck()
     }
 }
 
+int getch_ck()
+{
+    if (replay::replaying())
+        return replay::next_key();
+    return replay::record_key(_getch_ck());
+}
+
 static void unix_handle_terminal_resize()
 {
     console_shutdown();
@@ -1870,6 +1878,10 @@ static bool _headless_kbhit()
 /* This is Juho Snellman's modified kbhit, to work with macros */
 bool kbhit()
 {
+    // Replayed keys are handed out one at a time.
+    if (replay::replaying())
+        return false;
+
     if (_headless_mode)
         return _headless_kbhit();
 
@@ -33,7 +33,9 @@
  * At first use, the LOS code makes some precomputations,
  * filling a list of all relevant rays in one quadrant,
  * and filling data structures that allow calculating LOS
- * in a quadrant without checking each ray.
+ * in a quadrant without checking each ray. The results are
+ * the same for every game, so they're kept in the shared data
+ * image (see data-image.h) and used from there in place.
  *
  * The code provides functions for filling LOS information
  * around a given center efficiently, and for querying rays
@@ -48,8 +50,10 @@
 #include <cmath>
 
 #include "areas.h"
+#include "beam.h"
 #include "coord.h"
 #include "coordit.h"
+#include "data-image.h"
 #include "env.h"
 #include "losglobal.h"
 #include "mon-act.h"
@@ -64,32 +68,73 @@
 // These store all unique (in terms of footprint) full rays.
 // The footprint of ray=fullray[i] consists of ray.length cells,
 // stored in ray_coords[ray.start..ray.length-1].
-// These are filled during precomputation (_register_ray).
-// XXX: fullrays is not needed anymore after precomputation.
+// These are filled during precomputation (_register_ray), and
+// emptied again once the tables below have been built.
 struct los_ray;
 static vector<los_ray> fullrays;
 static vector<coord_def> ray_coords;
 
+// The precomputed tables, as laid out in the shared data image:
+// this header, then
+//   uint32_t       target_first[LOS_TARGETS+1], padded to 8 bytes
+//   packed_cellray target_rays[min_rays]
+//   coord_def      ray_cells[ray_cells]
+//   coord_def      cellray_ends[min_rays]
+//   uint64_t       blockrays[LOS_TARGETS][words]
+// Bump the first part of LOS_TABLE_LAYOUT if this changes.
+struct los_table_header
+{
+    uint32_t ray_cells; // The cells of all full rays, as in ray_coords.
+    uint32_t min_rays;  // The number of minimal cellrays.
+    uint32_t words;     // The size of each blockrays bitmap.
+    uint32_t reserved;
+};
+
+// A minimal cellray, as find_ray uses it.
+struct packed_cellray
+{
+    // The full ray that it's a prefix of.
+    double start_x, start_y;
+    double dir_x, dir_y;
+    // It passes through ray_cells[start..start+end].
+    uint32_t start;
+    uint32_t end;
+};
+
+#define LOS_TARGETS ((LOS_MAX_RANGE+1) * (LOS_MAX_RANGE+1))
+static const uint32_t LOS_TABLE_LAYOUT = (1 << 24) | (LOS_MAX_RANGE << 16)
+                                         | (LOS_MAX_ANGLE << 8)
+                                         | LOS_INTERCEPT_MULT;
+
+static const los_table_header *los_tables = nullptr;
+
 // These store all unique minimal cellrays. For each i,
 // cellray i ends in cellray_ends[i] and passes through
-// those cells p that have blockrays(p)[i] set. In other
-// words, blockrays(p)[i] is set iff an opaque cell p blocks
-// the cellray with index i.
-static vector<coord_def> cellray_ends;
-typedef FixedArray<bit_vector*, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> blockrays_t;
-static blockrays_t blockrays;
+// those cells p that have bit i of blockrays[p] set. In other
+// words, that bit is set iff an opaque cell p blocks the
+// cellray with index i.
+static const coord_def *cellray_ends = nullptr;
+static const uint64_t *blockrays     = nullptr;
 
 // We also store the minimal cellrays by target position
-// for efficient retrieval by find_ray.
-// XXX: Consider condensing this representation.
-struct cellray;
-static FixedArray<vector<cellray>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> min_cellrays;
+// for efficient retrieval by find_ray: those ending in target
+// t are target_rays[target_first[t]..target_first[t+1]-1],
+// best first. They pass through the cells in ray_cells.
+static const uint32_t *target_first      = nullptr;
+static const packed_cellray *target_rays = nullptr;
+static const coord_def *ray_cells        = nullptr;
 
 // Temporary arrays used in losight() to track which rays
 // are blocked or have seen a smoke cloud.
-// Allocated when doing the precomputations.
-static bit_vector *dead_rays     = nullptr;
-static bit_vector *smoke_rays    = nullptr;
+// Allocated when the tables are loaded.
+static vector<uint64_t> dead_rays;
+static vector<uint64_t> smoke_rays;
+
+// The index of a first-quadrant cell in target_first and blockrays.
+static int _target_index(const coord_def &p)
+{
+    return p.x * (LOS_MAX_RANGE + 1) + p.y;
+}
 
 class quadrant_iterator : public rectangle_iterator
 {
@@ -103,10 +148,9 @@ public:
 
 void clear_rays_on_exit()
 {
-    delete dead_rays;
-    delete smoke_rays;
-    for (quadrant_iterator qi; qi; ++qi)
-        delete blockrays(*qi);
+    dead_rays.clear();
+    smoke_rays.clear();
+    los_tables = nullptr;
 }
 
 // LOS radius.
@@ -304,10 +348,13 @@ static compare_type _compare_cellrays(const cellray& a, const cellray& b)
         return compare_type::neither;
 }
 
+typedef FixedArray<vector<cellray>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1>
+    min_cellrays_t;
+
 // Determine all minimal cellrays.
-// They're stored globally by target in min_cellrays,
+// They're stored by target in min_cellrays,
 // and returned as a list of indices into ray_coords.
-static vector<int> _find_minimal_cellrays()
+static vector<int> _find_minimal_cellrays(min_cellrays_t &min_cellrays)
 {
     FixedArray<list<cellray>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> minima;
     list<cellray>::iterator min_it;
@@ -382,13 +429,27 @@ static void _register_ray(geom::ray r)
     fullrays.push_back(ray);
 }
 
-static void _create_blockrays()
+// Append the bytes of the given values to the tables being built.
+template<typename T>
+static void _append(string &tables, const T *values, size_t count)
+{
+    tables.append(reinterpret_cast<const char *>(values), sizeof(T) * count);
+}
+
+static void _pad8(string &tables)
+{
+    tables.resize((tables.size() + 7) & ~(size_t) 7, '\0');
+}
+
+// Build the blocking information for all cellrays, and pack it
+// with the minimal cellrays into the tables described above.
+static string _pack_tables()
 {
     // First, we calculate blocking information for all cell rays.
     // Cellrays are numbered according to the index of their end
     // cell in ray_coords.
     const int n_cellrays = ray_coords.size();
-    blockrays_t all_blockrays;
+    FixedArray<bit_vector*, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> all_blockrays;
     for (quadrant_iterator qi; qi; ++qi)
         all_blockrays(*qi) = new bit_vector(n_cellrays);
 
@@ -407,32 +468,65 @@ static void _create_blockrays()
     // only the nonduplicated cellrays.
 
     // Determine minimal cellrays and store their indices in ray_coords.
-    vector<int> min_indices = _find_minimal_cellrays();
+    min_cellrays_t min_cellrays;
+    vector<int> min_indices = _find_minimal_cellrays(min_cellrays);
     const int n_min_rays    = min_indices.size();
-    cellray_ends.resize(n_min_rays);
+
+    los_table_header header;
+    header.ray_cells = ray_coords.size();
+    header.min_rays = n_min_rays;
+    header.words = (n_min_rays + 63) / 64;
+    header.reserved = 0;
+
+    vector<uint32_t> first(LOS_TARGETS + 1, 0);
+    vector<packed_cellray> by_target;
+    for (int t = 0; t < LOS_TARGETS; ++t)
+    {
+        first[t] = by_target.size();
+        const coord_def target(t / (LOS_MAX_RANGE + 1),
+                               t % (LOS_MAX_RANGE + 1));
+        ASSERT(_target_index(target) == t);
+        for (const cellray &c : min_cellrays(target))
+        {
+            by_target.push_back({ c.ray.r.start.x, c.ray.r.start.y,
+                                  c.ray.r.dir.x, c.ray.r.dir.y,
+                                  c.ray.start, c.end });
+        }
+    }
+    first[LOS_TARGETS] = by_target.size();
+    ASSERT(by_target.size() == (size_t) n_min_rays);
+
+    vector<coord_def> ends(n_min_rays);
     for (int i = 0; i < n_min_rays; ++i)
-        cellray_ends[i] = ray_coords[min_indices[i]];
+        ends[i] = ray_coords[min_indices[i]];
 
     // Compress blockrays accordingly.
+    vector<uint64_t> blocks(LOS_TARGETS * header.words, 0);
     for (quadrant_iterator qi; qi; ++qi)
     {
-        blockrays(*qi) = new bit_vector(n_min_rays);
+        uint64_t *block = &blocks[_target_index(*qi) * header.words];
         for (int i = 0; i < n_min_rays; ++i)
-        {
-            blockrays(*qi)->set(i, all_blockrays(*qi)
-                                   ->get(min_indices[i]));
-        }
+            if (all_blockrays(*qi)->get(min_indices[i]))
+                block[i / 64] |= (uint64_t) 1 << (i % 64);
     }
 
     // We can throw away all_blockrays now.
     for (quadrant_iterator qi; qi; ++qi)
         delete all_blockrays(*qi);
 
-    dead_rays  = new bit_vector(n_min_rays);
-    smoke_rays = new bit_vector(n_min_rays);
+    string tables;
+    _append(tables, &header, 1);
+    _append(tables, first.data(), first.size());
+    _pad8(tables);
+    _append(tables, by_target.data(), by_target.size());
+    _append(tables, ray_coords.data(), ray_coords.size());
+    _append(tables, ends.data(), ends.size());
+    _append(tables, blocks.data(), blocks.size());
 
     dprf("Cellrays: %d Fullrays: %u Minimal cellrays: %u",
           n_cellrays, (unsigned int)fullrays.size(), n_min_rays);
+
+    return tables;
 }
 
 static int _gcd(int x, int y)
@@ -453,16 +547,11 @@ static bool _complexity_lt(const pair<int,int>& lhs, const pair<int,int>& rhs)
     return lhs.first * lhs.second < rhs.first * rhs.second;
 }
 
-// Cast all rays
-static void raycast()
+// Cast all rays, and build the tables from them.
+static string _build_tables()
 {
-    static bool done_raycast = false;
-    if (done_raycast)
-        return;
-
     // Creating all rays for first quadrant
     // We have a considerable amount of overkill.
-    done_raycast = true;
 
     // register perpendiculars FIRST, to make them top choice
     // when selecting beams
@@ -503,7 +592,53 @@ static void raycast()
     }
 
     // Now create the appropriate blockrays array
-    _create_blockrays();
+    const string tables = _pack_tables();
+
+    // Only the packed tables are used from here on.
+    vector<los_ray>().swap(fullrays);
+    vector<coord_def>().swap(ray_coords);
+
+    return tables;
+}
+
+// Load the precomputed tables, building them first if the shared data
+// image doesn't have them yet.
+static void raycast()
+{
+    if (los_tables)
+        return;
+
+    size_t size;
+    const char *data = data_image::section("los", LOS_TABLE_LAYOUT,
+                                           _build_tables, &size);
+    ASSERT(size >= sizeof(los_table_header));
+    const los_table_header &header
+        = *reinterpret_cast<const los_table_header *>(data);
+
+    size_t offset = sizeof(los_table_header);
+    target_first = reinterpret_cast<const uint32_t *>(data + offset);
+    offset = (offset + sizeof(uint32_t) * (LOS_TARGETS + 1) + 7)
+             & ~(size_t) 7;
+    target_rays = reinterpret_cast<const packed_cellray *>(data + offset);
+    offset += sizeof(packed_cellray) * header.min_rays;
+    ray_cells = reinterpret_cast<const coord_def *>(data + offset);
+    offset += sizeof(coord_def) * header.ray_cells;
+    cellray_ends = reinterpret_cast<const coord_def *>(data + offset);
+    offset += sizeof(coord_def) * header.min_rays;
+    blockrays = reinterpret_cast<const uint64_t *>(data + offset);
+    offset += sizeof(uint64_t) * LOS_TARGETS * header.words;
+    ASSERT(offset == size);
+    ASSERT(target_first[LOS_TARGETS] == header.min_rays);
+
+    dead_rays.assign(header.words, 0);
+    smoke_rays.assign(header.words, 0);
+    los_tables = &header;
+}
+
+// Do the ray precalculations now rather than on first use.
+void init_rays()
+{
+    raycast();
 }
 
 static int _imbalance(ray_def ray, const coord_def& target)
@@ -558,32 +693,34 @@ static bool _find_ray_se(const coord_def& target, ray_def& ray,
     // Ensure the precalculations have been done.
     raycast();
 
-    const vector<cellray> &min = min_cellrays(target);
-    ASSERT(!min.empty());
-    cellray c = min[0]; // XXX: const cellray &c ?
+    const int t = _target_index(target);
+    const packed_cellray *min = &target_rays[target_first[t]];
+    const unsigned int n_min = target_first[t + 1] - target_first[t];
+    ASSERT(n_min);
+    const packed_cellray *c = &min[0];
     unsigned int index = 0;
 
     if (cycle)
-        dprf("cycling from %d (total %u)", ray.cycle_idx, (unsigned int)min.size());
+        dprf("cycling from %d (total %u)", ray.cycle_idx, n_min);
 
     unsigned int start = cycle ? ray.cycle_idx + 1 : 0;
-    ASSERT(start <= min.size());
+    ASSERT(start <= n_min);
 
     int blocked = OPC_OPAQUE;
     for (unsigned int i = start;
-         (blocked >= OPC_OPAQUE) && (i < start + min.size()); i++)
+         (blocked >= OPC_OPAQUE) && (i < start + n_min); i++)
     {
-        index = i % min.size();
-        c = min[index];
+        index = i % n_min;
+        c = &min[index];
         blocked = OPC_CLEAR;
         // Check all inner points.
-        for (unsigned int j = 0; j < c.end && blocked < OPC_OPAQUE; j++)
-            blocked += opc(c[j]);
+        for (unsigned int j = 0; j < c->end && blocked < OPC_OPAQUE; j++)
+            blocked += opc(ray_cells[c->start + j]);
     }
     if (blocked >= OPC_OPAQUE)
         return false;
 
-    ray = c.ray;
+    ray = ray_def(geom::ray(c->start_x, c->start_y, c->dir_x, c->dir_y));
     ray.cycle_idx = index;
 
     return true;
@@ -734,10 +871,11 @@ bool cell_see_cell_nocache(const coord_def& p1, const coord_def& p2)
 
 static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy)
 {
-    const unsigned int num_cellrays = cellray_ends.size();
+    const unsigned int num_cellrays = los_tables->min_rays;
+    const unsigned int words = los_tables->words;
 
-    dead_rays->reset();
-    smoke_rays->reset();
+    fill(dead_rays.begin(), dead_rays.end(), 0);
+    fill(smoke_rays.begin(), smoke_rays.end(), 0);
 
     for (quadrant_iterator qi; qi; ++qi)
     {
@@ -745,16 +883,21 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
         if (!dat.los_bounds(p))
             continue;
 
+        const uint64_t *block = &blockrays[_target_index(*qi) * words];
         switch (dat.opacity(p))
         {
         case OPC_OPAQUE:
             // Block the appropriate rays.
-            *dead_rays |= *blockrays(*qi);
+            for (unsigned int w = 0; w < words; ++w)
+                dead_rays[w] |= block[w];
             break;
         case OPC_HALF:
             // Block rays which have already seen a cloud.
-            *dead_rays  |= (*smoke_rays & *blockrays(*qi));
-            *smoke_rays |= *blockrays(*qi);
+            for (unsigned int w = 0; w < words; ++w)
+            {
+                dead_rays[w]  |= smoke_rays[w] & block[w];
+                smoke_rays[w] |= block[w];
+            }
             break;
         default:
             break;
@@ -766,7 +909,7 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
     for (unsigned int rayidx = 0; rayidx < num_cellrays; ++rayidx)
     {
         // make the cells seen by this ray at this point visible
-        if (!dead_rays->get(rayidx))
+        if (!(dead_rays[rayidx / 64] >> (rayidx % 64) & 1))
         {
             // This ray is alive, thus the end cell is visible.
             const coord_def p = coord_def(sx * cellray_ends[rayidx].x,
@@ -834,9 +977,17 @@ opacity_type mons_opacity(monster_type mc, los_type how)
 
 // Something that affects LOS (with default parameters)
 // has changed somewhere.
+static unsigned int los_changes = 0;
+
 static void _handle_los_change()
 {
     invalidate_agrid(false);
+    los_changes++;
+}
+
+unsigned int los_change_count()
+{
+    return los_changes;
 }
 
 static bool _mons_block_sight(const monster* mons)
@@ -867,6 +1018,7 @@ void los_monster_died(const monster* mon)
 // Might want to pass new/old terrain.
 void los_terrain_changed(const coord_def& p)
 {
+    clear_tracer_cache();
     invalidate_los_around(p);
     _handle_los_change();
 }
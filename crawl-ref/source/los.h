@@ -36,6 +36,7 @@ bool cell_see_cell_nocache(const coord_def& p1, const coord_def& p2);
 
 typedef SquareArray<bool, LOS_MAX_RANGE> los_grid;
 
+void init_rays();
 void clear_rays_on_exit();
 void losight(los_grid& sh, const coord_def& center,
              const opacity_func &opc = opc_default,
@@ -45,4 +46,8 @@ void los_actor_moved(const actor* act, const coord_def& oldpos);
 void los_monster_died(const monster* mon);
 void los_terrain_changed(const coord_def& p);
 void los_changed();
+
+// Goes up whenever something that might change line of sight does.
+unsigned int los_change_count();
+
 opacity_type mons_opacity(monster_type mc, los_type how);
@@ -49,6 +49,7 @@
 #include "options.h"
 #include "output.h"
 #include "prompt.h"
+#include "replay.h"
 #include "state.h"
 #include "state.h"
 #include "stringutil.h"
@@ -210,6 +211,10 @@ static int userfunc_getindex(const string &fname)
 // Returns the name of the file that contains macros.
 static string get_macro_file()
 {
+    // Replays use the recorded macros, and leave the player's own alone.
+    if (replay::replaying())
+        return replay::macro_file();
+
     string dir = !Options.macro_dir.empty() ? Options.macro_dir :
                  !SysEnv.crawl_dir.empty()  ? SysEnv.crawl_dir : "";
 
@@ -764,7 +769,7 @@ void process_command_on_record(command_type cmd)
     process_command(cmd);
 }
 
-static void write_map(FILE *f, const macromap &mp, const char *key)
+static void write_map(string &text, const macromap &mp, const char *key)
 {
     for (const auto &entry : mp)
     {
@@ -772,12 +777,37 @@ static void write_map(FILE *f, const macromap &mp, const char *key)
         // macro struct for all used keyboard commands.
         if (entry.second.size())
         {
-            fprintf(f, "%s%s\nA:%s\n\n", OUTS(key),
-                OUTS(vtostr(entry.first)), OUTS(vtostr(entry.second)));
+            text += make_stringf("%s%s\nA:%s\n\n", key,
+                vtostr(entry.first).c_str(), vtostr(entry.second).c_str());
         }
     }
 }
 
+/*
+ * The current keymaps and macros, in the format of the macro file.
+ */
+string macro_file_text()
+{
+    string text = make_stringf(
+        "# %s %s macro file\n"
+        "# WARNING: This file is entirely auto-generated.\n"
+        "\n"
+        "# Key Mappings:\n",
+        CRAWL, // ok, localizing the game name is not likely
+        Version::Long); // nor the version string
+    for (int mc = KMC_DEFAULT; mc < KMC_CONTEXT_COUNT; ++mc)
+    {
+        char buf[30] = "K:";
+        if (mc)
+            snprintf(buf, sizeof buf, "K%d:", mc);
+        write_map(text, Keymaps[mc], buf);
+    }
+
+    text += "# Command Macros:\n";
+    write_map(text, Macros, "M:");
+    return text;
+}
+
 /*
  * Saves macros into the macrofile, overwriting the old one.
  */
@@ -792,22 +822,7 @@ void macro_save()
         return;
     }
 
-    fprintf(f, "# %s %s macro file\n"
-               "# WARNING: This file is entirely auto-generated.\n"
-               "\n"
-               "# Key Mappings:\n",
-            OUTS(CRAWL), // ok, localizing the game name is not likely
-            OUTS(Version::Long)); // nor the version string
-    for (int mc = KMC_DEFAULT; mc < KMC_CONTEXT_COUNT; ++mc)
-    {
-        char buf[30] = "K:";
-        if (mc)
-            snprintf(buf, sizeof buf, "K%d:", mc);
-        write_map(f, Keymaps[mc], buf);
-    }
-
-    fprintf(f, "# Command Macros:\n");
-    write_map(f, Macros, "M:");
+    fputs(OUTS(macro_file_text()), f);
 
     crawl_state.unsaved_macros = false;
     fclose(f);
@@ -2022,10 +2037,13 @@ string keycode_to_name(int keycode, bool shorten)
 
 void macro_init()
 {
-    for (const auto &fn : Options.additional_macro_files)
-        _read_macros_from(fn.c_str());
+    // A replay's macro file already has everything the recorded game loaded.
+    if (!replay::replaying())
+        for (const auto &fn : Options.additional_macro_files)
+            _read_macros_from(fn.c_str());
 
     _read_macros_from(get_macro_file().c_str());
+    replay::macros_loaded();
 }
 
 void macro_userfn(const char *keys, const char *regname)
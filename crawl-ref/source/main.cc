@@ -92,6 +92,7 @@
 #include "map-knowledge.h"
 #include "mapmark.h"
 #include "maps.h"
+#include "mem-usage.h"
 #include "message.h"
 #include "misc.h"
 #include "mon-abil.h"
@@ -109,10 +110,12 @@
 #include "player.h"
 #include "player-notices.h"
 #include "player-reacts.h"
+#include "profiler.h"
 #include "prompt.h"
 #include "quiver.h"
 #include "random.h"
 #include "religion.h"
+#include "replay.h"
 #include "shopping.h"
 #include "shout.h"
 #include "skills.h"
@@ -156,6 +159,7 @@
 #include "wizard.h" // handle_wizard_command() and enter_explore_mode()
 #include "xom.h" // XOM_CLOUD_TRAIL_TYPE_KEY
 #include "zot.h"
+#include "zygote.h"
 
 // ----------------------------------------------------------------------
 // Globals whose construction/destruction order needs to be managed
@@ -288,14 +292,38 @@ int main(int argc, char *argv[])
     init_char_table(CSET_ASCII);
     init_monsters();
 
-    // Init name cache. Currently unused, but item_glyph will need these
-    // once implemented.
+    // The item name caches themselves are built on first use.
     init_properties();
     init_item_name_cache();
 
     // make sure all the expected data directories exist
     validate_basedirs();
 
+#ifdef USE_TILE_WEB
+    // In zygote mode, serve() only returns in a forked child, carrying the
+    // command line for that child's game. Parse it afresh.
+    vector<string> zygote_args;
+    vector<char*> zygote_argv;
+    if (!zygote::socket_path.empty())
+    {
+        zygote::serve(zygote_args);
+        zygote::socket_path.clear();
+        for (string &arg : zygote_args)
+            zygote_argv.push_back(&arg[0]);
+        zygote_argv.push_back(nullptr);
+        argc = zygote_args.size();
+        argv = zygote_argv.data();
+
+        get_system_environment();
+        SysEnv.cmd_args.clear();
+        if (!parse_args(argc, argv, true))
+        {
+            _show_commandline_options_help();
+            return 1;
+        }
+    }
+#endif
+
     {
         // Read the init file -- first pass. This pass ignores lua. It'll get
         // reread with lua on starting a game.
@@ -562,6 +590,12 @@ static void _show_commandline_options_help()
     puts("");
     puts("Arena options: (Stage a tournament between various monsters.)");
     puts("  -arena \"<monster list> v <monster list> arena:<arena map>\"");
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+    puts("  -arena-batch <file>    run each matchup in <file> headless, writing");
+    puts("                         per-fight results to arena-batch.jsonl and");
+    puts("                         a summary to arena-batch.result");
+    puts("  -arena-jobs <N>        run -arena-batch fights in N processes");
+#endif
 #ifdef DEBUG_DIAGNOSTICS
     puts("");
     puts("Diagnostic options:");
@@ -606,6 +640,21 @@ static void _show_commandline_options_help()
     puts("  -playable-json   list playable species, jobs, and character combos.");
     puts("  -branches-json   list branch data.");
     puts("  -no-player-bones do not write player's info to bones files.");
+    puts("  -turn-profile <file> profile turn processing, appending per-level");
+    puts("                   timings to <file> as JSON lines at game end.");
+    puts("  -memory-soft-limit <MB> trim caches when the process grows past");
+    puts("                   this size");
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+    puts("  -record-keys <file> record a new game's seed, options and keys");
+    puts("                   to <file>, for -replay.");
+    puts("  -replay <file>   replay a recorded game headless, printing each");
+    puts("                   turn's timing as JSON lines; fails if the game");
+    puts("                   diverges from the recording.");
+#endif
+#ifdef USE_TILE_WEB
+    puts("  -zygote <socket> load game data once, then fork a game for each");
+    puts("                   spawn request received on <socket>.");
+#endif
 
 #if defined(TARGET_OS_WINDOWS) && defined(USE_TILE_LOCAL)
     text_popup(help, L"Dungeon Crawl command line help");
@@ -2581,6 +2630,9 @@ void world_reacts()
     // All markers should be activated at this point.
     ASSERT(!env.markers.need_activate());
 
+    PROF_SCOPE(PROF_PHASE, "world_reacts");
+    clear_tracer_cache();
+
     you.rampage_hints.clear(); // only draw on your turn
 
     fire_final_effects();
@@ -2593,7 +2645,10 @@ void world_reacts()
         update_screen();
     }
 
-    update_monsters_in_view();
+    {
+        PROF_SCOPE(PROF_PHASE, "update_monsters_in_view");
+        update_monsters_in_view();
+    }
 
     reset_show_terrain();
 
@@ -2629,9 +2684,18 @@ void world_reacts()
     if (player_in_branch(BRANCH_ABYSS))
         maybe_shift_abyss_around_player();
 
-    abyss_morph();
-    apply_noises();
-    handle_monsters(true);
+    {
+        PROF_SCOPE(PROF_PHASE, "abyss_morph");
+        abyss_morph();
+    }
+    {
+        PROF_SCOPE(PROF_PHASE, "apply_noises");
+        apply_noises();
+    }
+    {
+        PROF_SCOPE(PROF_PHASE, "handle_monsters");
+        handle_monsters(true);
+    }
 
     // Monsters can schedule final effects, too!
     // (mostly by exploding)
@@ -2660,12 +2724,18 @@ void world_reacts()
         player_die(KILLED_BY_QUITTING);
     }
 
-    handle_time();
+    {
+        PROF_SCOPE(PROF_PHASE, "handle_time");
+        handle_time();
+    }
     // handle_time might have scheduled on death effects for monsters killed
     // by contamination explosions etc.
     fire_final_effects();
 
-    manage_clouds();
+    {
+        PROF_SCOPE(PROF_PHASE, "manage_clouds");
+        manage_clouds();
+    }
 
     handle_lurkers();
 
@@ -2681,13 +2751,19 @@ void world_reacts()
     clear_monster_flags();
     env.invis_knowledge.handle_time();
 
-    viewwindow();
+    {
+        PROF_SCOPE(PROF_PHASE, "viewwindow");
+        viewwindow();
+    }
 
     // Needs to happen after viewwindow() so that the map knowledge is up to
     // date to decide which monsters to exclude.
     add_auto_excludes();
 
-    update_screen();
+    {
+        PROF_SCOPE(PROF_PHASE, "update_screen");
+        update_screen();
+    }
 
     check_trapped();
     trigger_exploration_conducts();
@@ -2717,6 +2793,7 @@ void world_reacts()
         update_turn_count();
         msgwin_new_turn();
         crawl_state.lua_calls_no_turn = 0;
+        replay::turn_done();
         if ((crawl_state.game_is_sprint() && !(you.num_turns % 256)
                 || crawl_state.save_after_turn)
             && !you_are_delayed()
@@ -2735,6 +2812,8 @@ void world_reacts()
     // the loudest noise tracking for the next world_reacts cycle.
     you.los_noise_last_turn = you.los_noise_level;
     you.los_noise_level = 0;
+
+    mem_usage::check_soft_limit();
 }
 
 static command_type _get_next_cmd()
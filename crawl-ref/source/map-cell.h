@@ -115,7 +115,9 @@ struct map_cell
         _feat_colour = o._feat_colour;
         _cloud = o._cloud ? make_unique<cloud_info>(*o._cloud) : nullptr;
         _item = o._item ? make_unique<item_def>(*o._item) : nullptr;
-        _mons = o._mons ? make_unique<monster_info>(*o._mons) : nullptr;
+        // Monster info is shared rather than copied; it is only changed in
+        // place while loading.
+        _mons = o._mons;
 
         return *this;
     }
@@ -233,7 +235,14 @@ struct map_cell
     void set_monster(const monster_info& mi)
     {
         clear_monster();
-        _mons = make_unique<monster_info>(mi);
+        _mons = make_shared<monster_info>(mi);
+    }
+
+    // Share a snapshot from monster_info_snapshot().
+    void set_monster(shared_ptr<monster_info> mi)
+    {
+        clear_monster();
+        _mons = std::move(mi);
     }
 
     bool detected_monster() const
@@ -256,7 +265,7 @@ struct map_cell
     void set_detected_monster(monster_type mons)
     {
         clear_monster();
-        _mons = make_unique<monster_info>(MONS_SENSED);
+        _mons = make_shared<monster_info>(MONS_SENSED);
         _mons->base_type = mons;
         flags |= MAP_DETECTED_MONSTER;
     }
@@ -264,7 +273,7 @@ struct map_cell
     void set_invisible_monster(const monster* mon)
     {
         clear_monster();
-        _mons = make_unique<monster_info>(mon);
+        _mons = make_shared<monster_info>(mon);
         _mons->mb.set(MB_INVISIBLE, false); // Avoid redundant invisibility descriptions.
         flags |= MAP_INVISIBLE_MONSTER;
         _mons->mb.set(MB_KNOWN_INVIS);
@@ -272,7 +281,7 @@ struct map_cell
 
     void set_old_invisible_monster(const monster* mon)
     {
-        _mons = make_unique<monster_info>(mon->type, mon->base_monster);
+        _mons = make_shared<monster_info>(mon->type, mon->base_monster);
         _mons->mb.set(MB_INVISIBLE, false); // Avoid redundant invisibility descriptions.
         flags |= MAP_OLD_INVIS_MONSTER;
         _mons->mb.set(MB_REMEMBERED_INVIS);
@@ -397,5 +406,5 @@ private:
     colour_t _feat_colour = 0;
     unique_ptr<cloud_info> _cloud;
     unique_ptr<item_def> _item;
-    unique_ptr<monster_info> _mons;
+    shared_ptr<monster_info> _mons;
 };
@@ -0,0 +1,244 @@
+/**
+ * @file
+ * @brief Per-subsystem memory accounting, and the memory soft limit.
+**/
+
+#include "AppHdr.h"
+
+#include "mem-usage.h"
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "act-iter.h"
+#include "clua.h"
+#include "coordit.h"
+#include "dlua.h"
+#include "env.h"
+#include "files.h"
+#include "initfile.h"
+#include "json-wrapper.h"
+#include "message.h"
+#include "mon-info.h"
+#include "package.h"
+#include "player.h"
+#include "profiler.h"
+#include "prompt.h"
+#include "scroller.h"
+#include "stash.h"
+#include "stringutil.h"
+#include "syscalls.h"
+#include "travel.h"
+
+// How many turns apart the soft limit is checked.
+#define SOFT_LIMIT_CHECK_TURNS 100
+
+namespace mem_usage
+{
+    uint64_t soft_limit_mb = 0;
+
+    static int trims = 0;
+    static int last_limit_check = -1;
+
+    static const char *subsystem_names[] =
+    {
+        "env", "map_knowledge", "props", "stashes", "travel_cache",
+        "messages", "level_cache", "clua", "dlua", "caches",
+    };
+    COMPILE_CHECK(ARRAYSZ(subsystem_names) == NUM_MEM_SUBSYSTEMS);
+
+    size_t string_bytes(const string &s)
+    {
+        // Short strings are kept inside the string object itself, and an
+        // empty string has as much room as that buffer.
+        static const size_t inline_capacity = string().capacity();
+        return s.capacity() > inline_capacity ? s.capacity() + 1 : 0;
+    }
+
+    static size_t _resident_bytes()
+    {
+#ifdef __linux__
+        FILE *f = fopen_u("/proc/self/statm", "r");
+        if (!f)
+            return 0;
+        unsigned long size = 0, resident = 0;
+        const bool ok = fscanf(f, "%lu %lu", &size, &resident) == 2;
+        fclose(f);
+        return ok ? resident * sysconf(_SC_PAGESIZE) : 0;
+#else
+        return 0;
+#endif
+    }
+
+    static size_t _map_knowledge_memory()
+    {
+        size_t total = sizeof(env.map_knowledge);
+        for (rectangle_iterator ri(0); ri; ++ri)
+        {
+            const map_cell &cell = env.map_knowledge(*ri);
+            if (const item_def *item = cell.item())
+                total += sizeof(item_def) + item->props.memory_used();
+            if (const monster_info *mi = cell.monsterinfo())
+                total += sizeof(monster_info) + mi->props.memory_used();
+            if (cell.cloudinfo())
+                total += sizeof(cloud_info);
+        }
+        return total;
+    }
+
+    static size_t _props_memory()
+    {
+        size_t total = you.props.memory_used() + env.properties.memory_used();
+        for (monster_iterator mi; mi; ++mi)
+            total += mi->props.memory_used();
+        for (int i = 0; i < MAX_ITEMS; ++i)
+            if (env.item[i].defined())
+                total += env.item[i].props.memory_used();
+        for (int i = 0; i < ENDOFPACK; ++i)
+            if (you.inv[i].defined())
+                total += you.inv[i].props.memory_used();
+        return total;
+    }
+
+    report measure()
+    {
+        report r;
+        r.bytes[MEM_ENV] = sizeof(env) - sizeof(env.map_knowledge)
+                           + vector_bytes(env.mon_slots)
+                           + map_bytes(env.shop)
+                           + map_bytes(env.mid_cache);
+        r.bytes[MEM_MAP_KNOWLEDGE] = _map_knowledge_memory();
+        r.bytes[MEM_PROPS] = _props_memory();
+        r.bytes[MEM_STASHES] = StashTrack.memory_used();
+        r.bytes[MEM_TRAVEL_CACHE] = travel_cache.memory_used();
+        r.bytes[MEM_MESSAGES] = message_history_memory();
+        r.bytes[MEM_LEVEL_CACHE] = resident_levels_memory();
+        // Only counted where the interpreters use crawl's own allocator.
+        r.bytes[MEM_CLUA] = max(clua.memory_used, 0L);
+        r.bytes[MEM_DLUA] = max(dlua.memory_used, 0L);
+        r.bytes[MEM_CACHES] = monster_info_snapshot_memory()
+                              + options_file_cache_memory();
+        r.resident = _resident_bytes();
+        r.save_file = you.save ? you.save->get_size() : 0;
+        r.trims = trims;
+        return r;
+    }
+
+    static size_t _total(const report &r)
+    {
+        size_t total = 0;
+        for (size_t bytes : r.bytes)
+            total += bytes;
+        return total;
+    }
+
+    JsonNode *to_json()
+    {
+        const report r = measure();
+        JsonNode *subsystems = json_mkobject();
+        for (int i = 0; i < NUM_MEM_SUBSYSTEMS; ++i)
+        {
+            json_append_member(subsystems, subsystem_names[i],
+                               json_mknumber(r.bytes[i]));
+        }
+
+        JsonNode *out = json_mkobject();
+        json_append_member(out, "subsystems", subsystems);
+        json_append_member(out, "total", json_mknumber(_total(r)));
+        if (r.resident)
+            json_append_member(out, "resident", json_mknumber(r.resident));
+        json_append_member(out, "save_file", json_mknumber(r.save_file));
+        json_append_member(out, "soft_limit_mb",
+                           json_mknumber(soft_limit_mb));
+        json_append_member(out, "trims", json_mknumber(r.trims));
+        return out;
+    }
+
+    string summary()
+    {
+        const report r = measure();
+        string out = make_stringf("<white>%-16s %10s</white>\n",
+                                  "subsystem", "KiB");
+        for (int i = 0; i < NUM_MEM_SUBSYSTEMS; ++i)
+        {
+            out += make_stringf("%-16s %10.1f\n", subsystem_names[i],
+                                r.bytes[i] / 1024.0);
+        }
+        out += make_stringf("<white>%-16s %10.1f</white>\n\n", "total",
+                            _total(r) / 1024.0);
+
+        if (r.resident)
+        {
+            out += make_stringf("Resident set size: %.1f MiB\n",
+                                r.resident / (1024.0 * 1024.0));
+        }
+        out += make_stringf("Save file: %.1f KiB (on disk)\n",
+                            r.save_file / 1024.0);
+        if (soft_limit_mb)
+        {
+            out += make_stringf("Soft limit: %" PRIu64 " MiB, caches trimmed "
+                                "%d times\n", soft_limit_mb, r.trims);
+        }
+        else
+            out += "No soft limit.\n";
+        return out;
+    }
+
+    void trim_caches()
+    {
+        // Levels newer in memory than in the save have to be written out
+        // before they can be dropped.
+        flush_resident_levels();
+        discard_resident_levels();
+        clear_monster_info_snapshots();
+        clear_options_file_cache();
+        clua.gc();
+        dlua.gc();
+#ifdef __GLIBC__
+        malloc_trim(0);
+#endif
+        trims++;
+        profiler::count(PROF_COUNTER, "memory caches trimmed");
+    }
+
+    void check_soft_limit()
+    {
+        if (!soft_limit_mb)
+            return;
+        if (you.num_turns == last_limit_check
+            || you.num_turns % SOFT_LIMIT_CHECK_TURNS)
+        {
+            return;
+        }
+        last_limit_check = you.num_turns;
+
+        size_t size = _resident_bytes();
+        if (!size)
+            size = _total(measure());
+        if (size < soft_limit_mb * 1024 * 1024)
+            return;
+
+        dprf("Using %zu bytes, over the soft limit; trimming caches.", size);
+        trim_caches();
+    }
+
+#ifdef WIZARD
+    void wizard_memory_report()
+    {
+        formatted_scroller scr(FS_PREWRAPPED_TEXT);
+        scr.set_more();
+        scr.add_formatted_string(formatted_string::parse_string(summary()));
+        scr.show();
+
+        if (yesno("Trim the caches now?", true, 'n'))
+        {
+            trim_caches();
+            mpr("Caches trimmed.");
+        }
+    }
+#endif
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @brief Per-subsystem memory accounting, and the memory soft limit.
+**/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "json.h"
+
+using std::string;
+using std::vector;
+
+enum mem_subsystem_type
+{
+    MEM_ENV,            // the current level's grids, monsters and items
+    MEM_MAP_KNOWLEDGE,  // what the player knows of the current level
+    MEM_PROPS,          // props of the player, level, monsters and items
+    MEM_STASHES,        // the stash tracker
+    MEM_TRAVEL_CACHE,   // the travel cache
+    MEM_MESSAGES,       // the message history
+    MEM_LEVEL_CACHE,    // levels kept in memory, see level_cache_size
+    MEM_CLUA,           // the user script Lua interpreter
+    MEM_DLUA,           // the dungeon builder Lua interpreter
+    MEM_CACHES,         // caches that are dropped over the soft limit
+    NUM_MEM_SUBSYSTEMS
+};
+
+namespace mem_usage
+{
+    // Set by the -memory-soft-limit command line option, in megabytes, or
+    // 0 for no limit. Over it, the caches are trimmed.
+    extern uint64_t soft_limit_mb;
+
+    // These are estimates of the heap memory the containers themselves hold,
+    // not counting what their elements own, which callers add as needed.
+    size_t string_bytes(const string &s);
+
+    template<typename T>
+    size_t vector_bytes(const vector<T> &v)
+    {
+        return v.capacity() * sizeof(T);
+    }
+
+    // Each tree node also holds three links and its colour.
+    template<typename M>
+    size_t map_bytes(const M &m)
+    {
+        return m.size() * (sizeof(typename M::value_type) + 4 * sizeof(void*));
+    }
+
+    struct report
+    {
+        size_t bytes[NUM_MEM_SUBSYSTEMS];
+        // The process's resident set size, or 0 if it isn't known here.
+        size_t resident;
+        size_t save_file;
+        int trims;
+    };
+
+    report measure();
+    JsonNode *to_json();
+    string summary();
+
+    // Drop the caches, and return freed memory to the system if possible.
+    void trim_caches();
+    // Called every turn: checks the process's size against the soft limit
+    // every so often, trimming the caches if it's over.
+    void check_soft_limit();
+#ifdef WIZARD
+    void wizard_memory_report();
+#endif
+}
@@ -18,6 +18,7 @@
 #include "libutil.h"
 #include "luaterp.h"
 #include "macro.h"
+#include "mem-usage.h"
 #include "menu.h"
 #include "monster.h"
 #include "mon-util.h"
@@ -2209,6 +2210,20 @@ bool recent_error_messages()
     return false;
 }
 
+// Roughly how much memory the message history holds.
+size_t message_history_memory()
+{
+    const store_t& msgs = buffer.get_store();
+    size_t total = sizeof(buffer);
+    for (int i = 0; i < msgs.size(); ++i)
+    {
+        total += mem_usage::vector_bytes(msgs[i].messages);
+        for (const message_particle &particle : msgs[i].messages)
+            total += mem_usage::string_bytes(particle.text);
+    }
+    return total;
+}
+
 // We just write out the whole message store including empty/unused
 // messages. They'll be ignored when restoring.
 void save_messages(writer& outf)
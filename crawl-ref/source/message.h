@@ -169,6 +169,7 @@ void set_more_autoclear(bool on);
 
 string get_last_messages(int mcount, bool full = false);
 bool recent_error_messages();
+size_t message_history_memory();
 
 int channel_to_colour(msg_channel_type channel, int param = 0);
 bool strip_channel_prefix(string &text, msg_channel_type &channel,
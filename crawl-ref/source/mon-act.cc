@@ -11,6 +11,7 @@
 #include "areas.h"
 #include "arena.h"
 #include "attitude-change.h"
+#include "beam.h"
 #include "bloodspatter.h"
 #include "cloud.h"
 #include "colour.h"
@@ -53,6 +54,7 @@
 #include "movement.h"
 #include "nearby-danger.h"
 #include "player-notices.h"
+#include "profiler.h"
 #include "religion.h"
 #include "shout.h"
 #include "spl-book.h"
@@ -1861,6 +1863,9 @@ static void _pre_monster_move(monster& mons)
     // Apply monster enchantments once for every normal-speed
     // player turn.
     mons.ench_countdown -= you.time_taken;
+    // With nothing to apply, the countdown just catches up in one step.
+    if (mons.enchantments.empty() && mons.ench_countdown < 0)
+        mons.ench_countdown += div_round_up(-mons.ench_countdown, 10) * 10;
     while (mons.ench_countdown < 0)
     {
         mons.ench_countdown += 10;
@@ -1931,6 +1936,7 @@ static bool _mons_take_special_action(monster &mons, int old_energy)
         || mons.type == MONS_SLIME_CREATURE
         || mons.type == MONS_SLYMDRA)
     {
+        PROF_SCOPE(PROF_MON_ACTION, "spell_or_ability");
         // [ds] Special abilities shouldn't overwhelm
         // spellcasting in monsters that have both. This aims
         // to give them both roughly the same weight.
@@ -1946,10 +1952,13 @@ static bool _mons_take_special_action(monster &mons, int old_energy)
     if (is_sanctuary(mons.pos()))
         return false;
 
-    if (_handle_wand(mons))
     {
-        DEBUG_ENERGY_USE_REF("_handle_wand()");
-        return true;
+        PROF_SCOPE(PROF_MON_ACTION, "wand");
+        if (_handle_wand(mons))
+        {
+            DEBUG_ENERGY_USE_REF("_handle_wand()");
+            return true;
+        }
     }
 
     if (_handle_swoop_or_flank(mons))
@@ -1960,6 +1969,7 @@ static bool _mons_take_special_action(monster &mons, int old_energy)
 
     if (friendly_or_near)
     {
+        PROF_SCOPE(PROF_MON_ACTION, "throw");
         bolt beem = setup_targeting_beam(mons);
         if (handle_throw(&mons, beem, false, false, false))
         {
@@ -1992,6 +2002,118 @@ static bool _leash_range_exceeded(const monster* mons)
            && grid_distance(creator->pos(), mons->pos()) > max_dist;
 }
 
+/**
+ * Can this monster's action during off-level catch-up be worked out without
+ * running handle_monster_move()?
+ *
+ * A hostile monster that is asleep, unhurt and free of enchantments, with
+ * nothing around it to react to, just stands still: handle_behaviour()
+ * keeps it asleep and targeting its own square, and _monster_move() gives
+ * up on the empty step after its first two rolls. This checks for
+ * everything that could make it do more than that.
+ */
+static bool _dormant_during_catchup(const monster& mons)
+{
+    if (!you.doing_monster_catchup)
+        return false;
+
+    if (mons.behaviour != BEH_SLEEP
+        || mons.attitude != ATT_HOSTILE
+        || mons.foe != MHITNOT
+        || mons.summoner
+        || !mons.enchantments.empty()
+        || mons.hit_points < mons.max_hit_points
+        || mons_class_flag(mons.type, M_CONFUSED)
+        || crawl_state.disables[DIS_MON_ACT])
+    {
+        return false;
+    }
+
+    // Kinds with their own handling, some of which acts even in their sleep.
+    switch (mons.type)
+    {
+    case MONS_FULMINANT_PRISM:
+    case MONS_SHADOW_PRISM:
+    case MONS_SPLINTERFROST_BARRICADE:
+    case MONS_BLAZEHEART_CORE:
+    case MONS_RENDING_BLADE:
+    case MONS_HAUNTED_ARMOUR:
+    case MONS_BURSTSHROOM:
+    case MONS_TIAMAT:
+    case MONS_SIXFIRHY:
+    case MONS_JIANGSHI:
+    case MONS_BOULDER:
+    case MONS_HELLFIRE_MORTAR:
+    case MONS_DIAMOND_SAWBLADE:
+    case MONS_LIGHTNING_SPIRE:
+    case MONS_SOLAR_EMBER:
+    case MONS_BOUNDLESS_TESSERACT:
+    case MONS_TEST_SPAWNER:
+    case MONS_SPECTRAL_WEAPON:
+    case MONS_THORN_HUNTER:
+    case MONS_BOULDER_BEETLE:
+    case MONS_SLIME_CREATURE:
+    case MONS_SLYMDRA:
+    case MONS_WANDERING_MUSHROOM:
+    case MONS_DEATHCAP:
+    case MONS_LURKING_HORROR:
+        return false;
+    default:
+        break;
+    }
+    if (mons_is_projectile(mons)
+        || mons_is_seeker(mons)
+        || mons_is_player_shadow(mons)
+        || mons_is_tentacle_or_tentacle_segment(mons.type)
+        || mons_is_tentacle_head(mons_base_type(mons)))
+    {
+        return false;
+    }
+
+    // Nothing where it sleeps may hurt it or make it flee.
+    if (cloud_at(mons.pos())
+        || env.grid(mons.pos()) == DNGN_TOXIC_BOG
+        || env.level_state & (LSTATE_SLIMY_WALL | LSTATE_ICY_WALL)
+        || sanctuary_exists())
+    {
+        return false;
+    }
+
+    // Noticing the player, who may be invisible, takes rolls of its own.
+    return !mons.see_cell(you.pos()) && !mons.see_cell(env.old_player_pos);
+}
+
+/**
+ * Take a dormant monster's action during catch-up: what handle_monster_move()
+ * comes to for it, without working it all out. The rolls the full move makes
+ * are still made, so the gameplay RNG ends up exactly where it would have.
+ *
+ * @param mons            A monster passing _dormant_during_catchup().
+ * @param non_move_energy The energy it spends standing still.
+ */
+static void _rest_during_catchup(monster& mons, int non_move_energy)
+{
+    mons.shield_blocks = 0;
+    check_spectral_weapon(mons);
+
+    // As set by handle_behaviour() for a sleeping monster.
+    mons.target = mons.pos();
+    mons.firing_pos = mons.pos();
+
+    profiler::count(PROF_COUNTER, "catch-up resting monster moves");
+    mons.speed_increment -= non_move_energy;
+    if (mons.speed >= 100 || mons.is_stationary())
+        return;
+
+    // _monster_move()'s rolls for berserk and frenzied monsters, which it
+    // makes before anything else.
+    one_chance_in(10);
+    one_chance_in(5);
+
+    you.update_beholder(&mons);
+    you.update_fearmonger(&mons);
+}
+
 void handle_monster_move(monster* mons)
 {
     ASSERT(mons); // XXX: change to monster &mons
@@ -1999,6 +2121,9 @@ void handle_monster_move(monster* mons)
     if (!entry)
         return;
 
+    PROF_SCOPE(PROF_MON_ACTION, "handle_monster_move");
+    clear_tracer_cache();
+
     coord_def mmov;
 
     const bool disabled = crawl_state.disables[DIS_MON_ACT]
@@ -2016,6 +2141,12 @@ void handle_monster_move(monster* mons)
     if (!mons->has_action_energy())
         return;
 
+    if (_dormant_during_catchup(*mons))
+    {
+        _rest_during_catchup(*mons, non_move_energy);
+        return;
+    }
+
     if (!disabled)
         move_solo_tentacle(mons);
 
@@ -2470,6 +2601,7 @@ void handle_monster_move(monster* mons)
             return;
         }
 
+        PROF_SCOPE(PROF_MON_ACTION, "movement");
         if (!_monster_move(mons, mmov))
             mons->speed_increment -= non_move_energy;
     }
@@ -2764,17 +2896,20 @@ void clear_monster_flags()
 {
     // Clear any summoning flags so that lower indiced monsters get their
     // actions in the next round. Also clear one-turn deep sleep flag.
-    // Finally, track the highest index of monster still alive, for
-    // monster_iterator optimisation purposes.
+    // Finally, track the highest index of monster still alive, and drop
+    // empty slots from the slot list, for monster_iterator optimisation
+    // purposes. Slots not in the list are always empty.
     env.max_mon_index = 0;
-    for (int i = 0; i < MAX_MONSTERS; ++i)
+    erase_if(env.mon_slots, [](int i)
     {
-        if (env.mons[i].defined())
+        monster &mons = env.mons[i];
+        if (mons.defined())
         {
             env.max_mon_index = i;
-            env.mons[i].flags &= ~MF_JUST_SUMMONED & ~MF_JUST_SLEPT;
+            mons.flags &= ~MF_JUST_SUMMONED & ~MF_JUST_SLEPT;
         }
-    }
+        return mons.type == MONS_NO_MONSTER;
+    });
 }
 
 /**
@@ -14,6 +14,7 @@
 
 #include "abyss.h"
 #include "act-iter.h"
+#include "arena.h"
 #include "areas.h"
 #include "attack.h"
 #include "attitude-change.h"
@@ -5411,6 +5412,8 @@ bool handle_mon_spell(monster* mons)
     if (!(get_spell_flags(spell_cast) & (spflag::helpful | spflag::escape | spflag::recovery)))
         make_mons_stop_fleeing(mons);
 
+    if (crawl_state.game_is_arena())
+        arena_monster_cast(mons);
     mons_cast(mons, beem, spell_cast, flags);
     if (battlesphere && battlesphere_can_mirror(spell_cast))
         trigger_battlesphere(mons);
@@ -3786,6 +3786,7 @@ void monster_cleanup(monster* mons, bool reset)
     ASSERT(!invalid_monster(mons));
 
     crawl_state.mon_gone(mons);
+    clear_tracer_cache();
 
     if (mons->has_ench(ENCH_AWAKEN_FOREST))
     {
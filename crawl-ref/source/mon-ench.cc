@@ -13,6 +13,7 @@
 #include "act-iter.h"
 #include "areas.h"
 #include "attitude-change.h"
+#include "beam.h"
 #include "bloodspatter.h"
 #include "cloud.h"
 #include "coordit.h"
@@ -211,7 +212,10 @@ bool monster::add_ench(const mon_enchant &ench, bool stack_duration)
         added->set_duration(this, new_enchantment ? nullptr : &ench);
 
     if (new_enchantment)
+    {
+        clear_tracer_cache();
         add_enchantment_effect(ench);
+    }
 
     if (ench.ench == ENCH_CHARM
         || ench.ench == ENCH_NEUTRAL_BRIBED
@@ -407,6 +411,7 @@ bool monster::del_ench(enchant_type ench, bool quiet, bool effect)
 
     enchantments.erase(et);
     ench_cache.set(et, false);
+    clear_tracer_cache();
     if (effect)
         remove_enchantment_effect(me, quiet);
     return true;
@@ -28,6 +28,7 @@
 #include "items.h" // item_is_unusual
 #include "libutil.h"
 #include "los.h"
+#include "mem-usage.h"
 #include "message.h"
 #include "mon-abil.h"
 #include "mon-behv.h"
@@ -39,6 +40,7 @@
 #include "mon-util.h"
 #include "nearby-danger.h"
 #include "options.h"
+#include "profiler.h"
 #include "religion.h"
 #include "shout.h"
 #include "skills.h"
@@ -933,6 +935,97 @@ monster_info::monster_info(const monster* m, int milev)
     last_seen_at_turn = you.num_turns;
 }
 
+// Everything a monster_info of m depends on that can change during a turn
+// without m being replaced: the monster's position, health, enchantments,
+// attitude, behaviour and equipment, and the player's side of things.
+static vector<int> _observable_state(const monster* m)
+{
+    vector<int> state =
+    {
+        (int) m->mid, m->type, m->base_monster, (int) m->number,
+        (int) m->get_client_id(), m->pos().x, m->pos().y,
+        mons_get_damage_level(*m), m->max_hit_points, m->get_hit_dice(),
+        (int) m->flags.flags, m->attitude, m->behaviour, m->foe, m->colour,
+        (int) m->summoner, (int) m->props.size(), (int) m->spells.size(),
+        m->constricting ? (int) m->constricting->size() : 0,
+        (int) m->constricted_by,
+        you.pos().x, you.pos().y, you.experience_level,
+        you.can_see_invisible(), you.nightvision(), you.visible_to(m),
+        you.beheld_by(*m), you.afraid_of(m), crawl_state.arena_suspended,
+        (int) los_change_count(),
+    };
+
+    for (const auto &entry : m->enchantments)
+    {
+        state.push_back(entry.first);
+        state.push_back(entry.second.degree);
+    }
+
+    for (int i = 0; i < NUM_MONSTER_SLOTS; i++)
+    {
+        state.push_back(m->inv[i]);
+        if (m->inv[i] == NON_ITEM)
+            continue;
+        const item_def &item = env.item[m->inv[i]];
+        state.insert(state.end(), { item.base_type, item.sub_type, item.plus,
+                                    item.plus2, item.special,
+                                    (int) item.flags, item.quantity });
+    }
+    return state;
+}
+
+struct monster_info_snapshot_entry
+{
+    vector<int> state;
+    shared_ptr<monster_info> info;
+};
+
+// Snapshots taken this turn, by mid.
+static unordered_map<mid_t, monster_info_snapshot_entry> info_snapshots;
+static int info_snapshot_turn = -1;
+
+shared_ptr<monster_info> monster_info_snapshot(const monster* m)
+{
+    if (info_snapshot_turn != you.num_turns)
+    {
+        info_snapshots.clear();
+        info_snapshot_turn = you.num_turns;
+    }
+
+    vector<int> state = _observable_state(m);
+    monster_info_snapshot_entry &entry = info_snapshots[m->mid];
+    if (entry.info && entry.state == state)
+    {
+        profiler::count(PROF_COUNTER, "monster_info snapshots reused");
+        return entry.info;
+    }
+
+    profiler::count(PROF_COUNTER, "monster_info snapshots built");
+    entry.state = std::move(state);
+    entry.info = make_shared<monster_info>(m);
+    return entry.info;
+}
+
+size_t monster_info_snapshot_memory()
+{
+    size_t total = mem_usage::map_bytes(info_snapshots);
+    for (const auto &entry : info_snapshots)
+    {
+        total += mem_usage::vector_bytes(entry.second.state);
+        if (entry.second.info.use_count() == 1)
+        {
+            total += sizeof(monster_info)
+                     + entry.second.info->props.memory_used();
+        }
+    }
+    return total;
+}
+
+void clear_monster_info_snapshots()
+{
+    info_snapshots.clear();
+}
+
 /// Player-known max HP information for a monster: "about 55", "243".
 int monster_info::get_known_max_hp() const
 {
@@ -2025,6 +2118,8 @@ void get_nearby_monster_info(vector<monster_info>& mons,
         {
             if (invis_mons && !mon->visible_to(&you))
                 invis_mons->emplace_back(mon);
+            else if (mon->visible_to(&you))
+                mons.push_back(*monster_info_snapshot(mon));
             else
                 mons.emplace_back(mon);
         }
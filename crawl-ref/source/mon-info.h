@@ -524,6 +524,15 @@ protected:
     void _add_constriction_info(const monster* mon);
 };
 
+// A monster_info for a monster the player can see, shared with anyone else
+// who asked for the same monster this turn while it looked the same. It
+// mustn't be modified.
+shared_ptr<monster_info> monster_info_snapshot(const monster* m);
+// The memory held by snapshots that nothing else is using, and a way to
+// drop them all.
+size_t monster_info_snapshot_memory();
+void clear_monster_info_snapshots();
+
 void get_nearby_monster_info(vector<monster_info>& mons,
                              vector<monster_info>* invis_mons = nullptr);
 
@@ -47,6 +47,7 @@ public:
                                 mon_pick_vetoer vetoer = nullptr);
 
     virtual bool veto(monster_type mon) override;
+    virtual bool can_veto() const override { return _veto != nullptr; }
 
 private:
     mon_pick_vetoer _veto;
@@ -60,6 +61,7 @@ public:
         : monster_picker(), pos(_pos), posveto(_posveto) { };
 
     virtual bool veto(monster_type mon) override;
+    virtual bool can_veto() const override { return true; }
 
 protected:
     const coord_def &pos;
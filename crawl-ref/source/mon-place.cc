@@ -837,8 +837,13 @@ monster* get_free_monster()
     for (auto &mons : menv_real)
         if (mons.type == MONS_NO_MONSTER)
         {
-            if (mons.mindex() > env.max_mon_index)
-                env.max_mon_index = mons.mindex();
+            const int idx = mons.mindex();
+            if (idx > env.max_mon_index)
+                env.max_mon_index = idx;
+            auto slot = lower_bound(env.mon_slots.begin(),
+                                    env.mon_slots.end(), idx);
+            if (slot == env.mon_slots.end() || *slot != idx)
+                env.mon_slots.insert(slot, idx);
 
             mons.reset();
             return &mons;
@@ -5265,6 +5265,7 @@ void reset_all_monsters()
         }
         mons.reset();
     }
+    env.mon_slots.clear();
 
     env.mid_cache.clear();
 }
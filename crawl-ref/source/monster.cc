@@ -12,6 +12,7 @@
 
 #include "abyss.h" // splash_corruption
 #include "act-iter.h"
+#include "arena.h"
 #include "areas.h"
 #include "artefact.h"
 #include "art-enum.h"
@@ -4354,6 +4355,8 @@ int monster::hurt(const actor *agent, int amount, beam_type flavour,
 
         amount = min(amount, hit_points);
         hit_points -= amount;
+        if (crawl_state.game_is_arena())
+            arena_monster_hurt(this, agent, amount);
 
         if (flavour == BEAM_DESTRUCTION || flavour == BEAM_MINDBURST)
         {
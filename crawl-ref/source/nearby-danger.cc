@@ -25,9 +25,11 @@
 #include "monster.h"
 #include "mon-movetarget.h"
 #include "mon-pathfind.h"
+#include "mon-place.h"
 #include "mon-tentacle.h"
 #include "player.h"
 #include "player-stats.h"
+#include "profiler.h"
 #include "spl-damage.h"
 #include "stringutil.h"
 #include "state.h"
@@ -37,6 +39,114 @@
 #include "travel.h"
 #include "zot.h" // decr_zot_clock
 
+// Connected components of the level's terrain, one labelling for each monster
+// habitat that has needed one. A component is a set of cells that a monster of
+// that habitat could walk between, treating every closed door as passable and
+// ignoring other monsters; so cells in different components are certainly
+// not connected for any such monster, while cells in the same one may or may
+// not be. Labels are built lazily, and thrown away whenever the terrain no
+// longer matches what they were built from.
+struct reachability_index
+{
+    FixedArray<dungeon_feature_type, GXM, GYM> grid;
+    bool built = false;
+    // 0 for cells the habitat can't enter, otherwise the component number.
+    map<habitat_type, unique_ptr<FixedArray<int, GXM, GYM>>> labels;
+};
+
+static reachability_index reach_index;
+
+static bool _reach_passable(habitat_type hab, const coord_def &p)
+{
+    const dungeon_feature_type feat = env.grid(p);
+    // monster_pathfind may assume unknown terrain to be traversable.
+    return feat == DNGN_UNSEEN
+           || feat_is_closed_door(feat)
+           || habitat_is_compatible(hab, feat);
+}
+
+static void _reach_label_components(habitat_type hab,
+                                    FixedArray<int, GXM, GYM> &labels)
+{
+    labels.init(0);
+    int next_label = 0;
+    vector<coord_def> todo;
+    for (rectangle_iterator ri(1); ri; ++ri)
+    {
+        if (labels(*ri) || !_reach_passable(hab, *ri))
+            continue;
+
+        labels(*ri) = ++next_label;
+        todo.push_back(*ri);
+        while (!todo.empty())
+        {
+            const coord_def p = todo.back();
+            todo.pop_back();
+            for (adjacent_iterator ai(p); ai; ++ai)
+            {
+                if (in_bounds(*ai) && !labels(*ai)
+                    && _reach_passable(hab, *ai))
+                {
+                    labels(*ai) = next_label;
+                    todo.push_back(*ai);
+                }
+            }
+        }
+    }
+}
+
+static const FixedArray<int, GXM, GYM> &_reach_labels(habitat_type hab)
+{
+    bool same_terrain = reach_index.built;
+    for (rectangle_iterator ri(0); same_terrain && ri; ++ri)
+        same_terrain = reach_index.grid(*ri) == env.grid(*ri);
+
+    if (!same_terrain)
+    {
+        reach_index.grid = env.grid;
+        reach_index.built = true;
+        reach_index.labels.clear();
+    }
+
+    auto &labels = reach_index.labels[hab];
+    if (!labels)
+    {
+        profiler::count(PROF_COUNTER, "reachability labellings");
+        labels = make_unique<FixedArray<int, GXM, GYM>>();
+        _reach_label_components(hab, *labels);
+    }
+    return *labels;
+}
+
+// Could mon possibly have a path to the player? If this says no, there's
+// certainly no path monster_pathfind could find; if yes, there may be.
+static bool _may_reach_player(const monster &mon)
+{
+    const coord_def start = mon.pos();
+    const coord_def target = you.pos();
+    if (grid_distance(start, target) <= 1)
+        return true;
+
+    // Neither the monster's own cell nor the player's need be passable
+    // for the monster, so look at the cells next to them.
+    const auto &labels = _reach_labels(mons_habitat(mon));
+    vector<int> near_player;
+    for (adjacent_iterator ai(target); ai; ++ai)
+        if (in_bounds(*ai) && labels(*ai))
+            near_player.push_back(labels(*ai));
+
+    for (adjacent_iterator ai(start); ai; ++ai)
+    {
+        if (in_bounds(*ai) && labels(*ai)
+            && find(near_player.begin(), near_player.end(), labels(*ai))
+               != near_player.end())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Checks if this is a monster that should be completely ignored for autoexplore
 // or tension purposes. This errs on the side of false positives, since there
 // are many situations where a monster is *realistically* harmless, but cannot
@@ -70,8 +180,18 @@ bool mons_is_irrelevant(const monster* mon)
         return false;
     }
 
+    // If the monster is cut off from the player entirely, there's no need
+    // to search for a path.
+    if (!_may_reach_player(*mon))
+    {
+        profiler::count(PROF_COUNTER, "pathfinds skipped by reachability");
+        mon->travel_target = MTRAV_KNOWN_UNREACHABLE;
+        return true;
+    }
+
     // Try to find a path from monster to player, using the map as it's
     // known to the player and assuming unknown terrain to be traversable.
+    profiler::count(PROF_COUNTER, "irrelevance pathfinds");
     monster_pathfind mp;
     const int range = mons_tracking_range(mon);
     // At the very least, we shouldn't consider a visible monster with a
@@ -22,6 +22,7 @@
 #include "piety-info.h"
 #include "prompt.h"
 #include "religion.h"
+#include "replay.h"
 #include "shopping.h"
 #include "skills.h"
 #include "spl-book.h"
@@ -386,9 +387,11 @@ void setup_game(const newgame_def& ng,
         if (ng.type == GAME_TYPE_NORMAL)
             crawl_state.type = GAME_TYPE_CUSTOM_SEED;
     }
-    else if (Options.seed && ng.type != GAME_TYPE_CUSTOM_SEED)
+    else if (Options.seed && ng.type != GAME_TYPE_CUSTOM_SEED
+             && !replay::replaying())
     {
         // there's a seed lingering in the options, but we shouldn't use it.
+        // A replay sets the recorded seed there, and does use it.
         Options.seed = 0;
     }
     else if (!Options.seed && ng.type == GAME_TYPE_CUSTOM_SEED)
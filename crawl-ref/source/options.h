@@ -375,6 +375,8 @@ struct base_game_options
 
     virtual void reset_aliases(bool clear=true);
     void include(const string &file, bool resolve, bool runscripts);
+    bool read_options_file(const string &file, bool runscripts,
+                           bool clear_aliases = true);
     string resolve_include(const string &file, const char *type = "");
     bool was_included(const string &file) const;
     static string resolve_include(string including_file, string included_file,
@@ -394,9 +396,10 @@ protected:
     set<string> included;  // Files we've included already.
 
     vector<GameOption*> option_behaviour;
-    map<string, GameOption*> options_by_name;
+    unordered_map<string, GameOption*> options_by_name;
     virtual const vector<GameOption*> build_options_list();
-    map<string, GameOption*> build_options_map(const vector<GameOption*> &opts);
+    unordered_map<string, GameOption*> build_options_map(
+        const vector<GameOption*> &opts);
 
     string unalias(const string &key) const;
     string expand_vars(const string &field) const;
@@ -457,6 +460,7 @@ public:
     string game_seed; // string version of the rc option
     uint64_t    seed_from_rc;
     level_gen_type pregen_dungeon;
+    int         level_cache_size; // MB of recently used levels kept in memory
 
 #ifdef DGL_SIMPLE_MESSAGING
     bool        messaging;      // Check for messages.
@@ -859,6 +863,7 @@ public:
     string      fsim_mode;
     bool        fsim_csv;
     int         fsim_rounds;
+    int         fsim_jobs;
     string      fsim_mons;
     vector<string> fsim_scale;
     vector<string> fsim_kit;
@@ -0,0 +1,213 @@
+/**
+ * @file
+ * @brief Lightweight scoped-timer profiling of turn processing.
+**/
+
+#include "AppHdr.h"
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <map>
+
+#include "files.h"
+#include "json-wrapper.h"
+#include "level-id.h"
+#include "message.h"
+#include "player.h"
+#include "prompt.h"
+#include "scroller.h"
+#include "stringutil.h"
+#include "syscalls.h"
+#include "unicode.h"
+#include "version.h"
+
+namespace profiler
+{
+    bool enabled = false;
+    string output_file;
+
+    struct prof_stat
+    {
+        int64_t calls = 0;
+        int64_t total_us = 0;
+        int64_t max_us = 0;
+    };
+
+    typedef pair<prof_category_type, string> prof_key;
+    typedef map<prof_key, prof_stat> level_profile;
+
+    static map<level_id, level_profile> profiles;
+
+    static const char *category_names[] =
+    {
+        "phase", "monster_action", "spell_tracer", "lua_hook",
+        "options_file", "counter",
+    };
+    COMPILE_CHECK(ARRAYSZ(category_names) == NUM_PROF_CATEGORIES);
+
+    static prof_stat &_stat_for(prof_category_type cat, const char *name)
+    {
+        return profiles[level_id::current()][prof_key(cat, name)];
+    }
+
+    void record(prof_category_type cat, const char *name, int64_t usecs)
+    {
+        if (!enabled)
+            return;
+        prof_stat &stat = _stat_for(cat, name);
+        stat.calls++;
+        stat.total_us += usecs;
+        stat.max_us = max(stat.max_us, usecs);
+    }
+
+    void count(prof_category_type cat, const char *name, int n)
+    {
+        if (!enabled)
+            return;
+        _stat_for(cat, name).calls += n;
+    }
+
+    void reset()
+    {
+        profiles.clear();
+    }
+
+    static vector<pair<prof_key, prof_stat>> _sorted(const level_profile &lp)
+    {
+        vector<pair<prof_key, prof_stat>> entries(lp.begin(), lp.end());
+        stable_sort(entries.begin(), entries.end(),
+            [](const pair<prof_key, prof_stat> &a,
+               const pair<prof_key, prof_stat> &b)
+            {
+                if (a.first.first != b.first.first)
+                    return a.first.first < b.first.first;
+                return a.second.total_us > b.second.total_us;
+            });
+        return entries;
+    }
+
+    static JsonNode *_entry_json(const level_id &lev, const prof_key &key,
+                                 const prof_stat &stat)
+    {
+        JsonNode *entry = json_mkobject();
+        json_append_member(entry, "level", json_mkstring(lev.describe()));
+        json_append_member(entry, "category",
+                           json_mkstring(category_names[key.first]));
+        json_append_member(entry, "name", json_mkstring(key.second));
+        json_append_member(entry, "calls", json_mknumber(stat.calls));
+        if (key.first != PROF_COUNTER)
+        {
+            json_append_member(entry, "total_us",
+                               json_mknumber(stat.total_us));
+            json_append_member(entry, "max_us", json_mknumber(stat.max_us));
+        }
+        return entry;
+    }
+
+    JsonNode *to_json()
+    {
+        JsonNode *entries = json_mkarray();
+        for (const auto &lp : profiles)
+            for (const auto &entry : _sorted(lp.second))
+            {
+                json_append_element(entries,
+                    _entry_json(lp.first, entry.first, entry.second));
+            }
+        return entries;
+    }
+
+    string summary()
+    {
+        if (profiles.empty())
+            return "No turns have been profiled.\n";
+
+        string out;
+        for (const auto &lp : profiles)
+        {
+            out += make_stringf("<yellow>%s</yellow>\n",
+                                lp.first.describe().c_str());
+            out += make_stringf("<white>%-14s %-28s %8s %10s %8s %8s</white>\n",
+                                "category", "name", "calls", "total ms",
+                                "avg us", "max us");
+            for (const auto &entry : _sorted(lp.second))
+            {
+                const prof_stat &stat = entry.second;
+                if (entry.first.first == PROF_COUNTER)
+                {
+                    out += make_stringf("%-14s %-28s %8" PRId64 "\n",
+                        category_names[entry.first.first],
+                        chop_string(entry.first.second, 28).c_str(),
+                        stat.calls);
+                    continue;
+                }
+                out += make_stringf("%-14s %-28s %8" PRId64 " %10.2f %8"
+                                    PRId64 " %8" PRId64 "\n",
+                    category_names[entry.first.first],
+                    chop_string(entry.first.second, 28).c_str(),
+                    stat.calls, stat.total_us / 1000.0,
+                    stat.calls ? stat.total_us / stat.calls : 0,
+                    stat.max_us);
+            }
+            out += "\n";
+        }
+        return out;
+    }
+
+    /**
+     * Append the accumulated profile to the -turn-profile file, one JSON
+     * object per (level, category, name) line, then start afresh.
+     */
+    void write_jsonl()
+    {
+        if (output_file.empty() || profiles.empty())
+            return;
+
+        FILE *f = fopen_u(output_file.c_str(), "a");
+        if (!f)
+        {
+            mprf(MSGCH_ERROR, "Unable to write turn profile to %s: %s",
+                 output_file.c_str(), strerror(errno));
+            return;
+        }
+
+        for (const auto &lp : profiles)
+            for (const auto &entry : _sorted(lp.second))
+            {
+                JsonWrapper line(_entry_json(lp.first, entry.first,
+                                             entry.second));
+                json_append_member(line.node, "player",
+                                   json_mkstring(you.your_name));
+                json_append_member(line.node, "version",
+                                   json_mkstring(Version::Long));
+                fprintf(f, "%s\n", line.to_string().c_str());
+            }
+        fclose(f);
+        reset();
+    }
+
+#ifdef WIZARD
+    void wizard_profile()
+    {
+        if (!enabled)
+        {
+            enabled = true;
+            mpr("Turn profiling enabled.");
+            return;
+        }
+
+        formatted_scroller scr(FS_PREWRAPPED_TEXT);
+        scr.set_more();
+        scr.add_formatted_string(formatted_string::parse_string(summary()));
+        scr.show();
+
+        if (yesno("Stop profiling and clear the counters?", true, 'n'))
+        {
+            enabled = false;
+            reset();
+            mpr("Turn profiling disabled.");
+        }
+    }
+#endif
+}
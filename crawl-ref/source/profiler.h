@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Lightweight scoped-timer profiling of turn processing.
+**/
+
+#pragma once
+
+#include <chrono>
+#include <string>
+
+#include "json.h"
+
+using std::string;
+
+enum prof_category_type
+{
+    PROF_PHASE,         // world_reacts() and its major steps
+    PROF_MON_ACTION,    // what a monster spent its turn deciding or doing
+    PROF_SPELL_TRACER,  // fire_tracer(), by spell or beam name
+    PROF_LUA_HOOK,      // named Lua hooks and callbacks
+    PROF_OPTIONS_FILE,  // options files read, with the files they include
+    PROF_COUNTER,       // plain event counters, with no timing
+    NUM_PROF_CATEGORIES
+};
+
+namespace profiler
+{
+    // Profiling is always compiled in, but does nothing (beyond testing
+    // this flag) unless it has been switched on, either with the
+    // -turn-profile command line option or from wizard mode.
+    extern bool enabled;
+    // If set, the per-level profile is appended to this file as JSON lines
+    // when the game ends or is saved.
+    extern string output_file;
+
+    void record(prof_category_type cat, const char *name, int64_t usecs);
+    void count(prof_category_type cat, const char *name, int n = 1);
+    void reset();
+
+    JsonNode *to_json();
+    string summary();
+    void write_jsonl();
+#ifdef WIZARD
+    void wizard_profile();
+#endif
+
+    class scope_timer
+    {
+    public:
+        scope_timer(prof_category_type cat, const char *name)
+            : category(cat), label(name), active(enabled)
+        {
+            if (active)
+                start = std::chrono::steady_clock::now();
+        }
+
+        ~scope_timer()
+        {
+            if (!active)
+                return;
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            record(category, label,
+                   std::chrono::duration_cast<std::chrono::microseconds>(
+                       elapsed).count());
+        }
+
+        scope_timer(const scope_timer&) = delete;
+        scope_timer &operator=(const scope_timer&) = delete;
+
+    private:
+        prof_category_type category;
+        const char *label;
+        bool active;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+// Time the rest of the enclosing block under the given category and name.
+// The name is only kept as a pointer, so it must outlive the block.
+#define PROF_SCOPE(cat, name) \
+    profiler::scope_timer PROF_CONCAT(_prof_scope_, __LINE__)(cat, name)
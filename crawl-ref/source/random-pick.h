@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <map>
+
 #include "random.h"
 
 enum distrib_type
@@ -27,6 +30,16 @@ struct random_pick_entry
     T value;
 };
 
+// The entries of a weight list that are in range at one level, with their
+// rarities at that level and the running total of those rarities.
+template <typename T>
+struct random_pick_table
+{
+    vector<T> values;
+    vector<int> rarities;
+    vector<int> cumulative;
+};
+
 template <typename T, int max>
 class random_picker
 {
@@ -38,6 +51,13 @@ public:
     int rarity_at(const random_pick_entry<T>& pop,
                   int depth);
     virtual bool veto(T) { return false; }
+    // Subclasses that override veto() must return true here whenever veto()
+    // might reject something; otherwise picks skip calling veto() entirely.
+    virtual bool can_veto() const { return false; }
+
+private:
+    const random_pick_table<T> &table_at(
+        const vector<random_pick_entry<T>>& weights, int level);
 };
 
 template <typename T, int max>
@@ -45,28 +65,77 @@ random_picker<T, max>::~random_picker()
 {
 }
 
+/**
+ * Get the (cached) table of entries of a weight list that are in range at
+ * the given level. Weight lists are static data, so tables are keyed by the
+ * list's address and never invalidated.
+ */
 template <typename T, int max>
-T random_picker<T, max>::pick(const vector<random_pick_entry<T>>& weights, int level,
-                              T none)
+const random_pick_table<T> &random_picker<T, max>::table_at(
+    const vector<random_pick_entry<T>>& weights, int level)
 {
-    struct { T value; int rarity; } valid[max];
-    int nvalid = 0;
-    int totalrar = 0;
+    static map<pair<const random_pick_entry<T>*, int>,
+               random_pick_table<T>> tables;
+
+    const auto key = make_pair(weights.data(), level);
+    auto found = tables.find(key);
+    if (found != tables.end())
+    {
+        ASSERT(found->second.values.size() <= weights.size());
+        return found->second;
+    }
 
+    random_pick_table<T> &table = tables[key];
+    int totalrar = 0;
     for (const random_pick_entry<T>& pop : weights)
     {
         if (level < pop.minr || level > pop.maxr)
             continue;
 
-        if (veto(pop.value))
-            continue;
-
         int rar = rarity_at(pop, level);
         ASSERTM(rar > 0, "Rarity %d: %d at level %d", rar, pop.value, level);
 
-        valid[nvalid].value = pop.value;
-        valid[nvalid].rarity = rar;
         totalrar += rar;
+        table.values.push_back(pop.value);
+        table.rarities.push_back(rar);
+        table.cumulative.push_back(totalrar);
+    }
+    return table;
+}
+
+template <typename T, int max>
+T random_picker<T, max>::pick(const vector<random_pick_entry<T>>& weights, int level,
+                              T none)
+{
+    const random_pick_table<T> &table = table_at(weights, level);
+    const int ntable = table.values.size();
+
+    if (!can_veto())
+    {
+        if (!ntable)
+            return none;
+
+        const int roll = random2(table.cumulative.back()); // the roll!
+        const auto it = upper_bound(table.cumulative.begin(),
+                                    table.cumulative.end(), roll);
+        ASSERT(it != table.cumulative.end());
+        return table.values[it - table.cumulative.begin()];
+    }
+
+    // Vetoes can depend on the caller's state (e.g. the position being
+    // filled), so apply them afresh, in list order, for each pick.
+    struct { T value; int rarity; } valid[max];
+    int nvalid = 0;
+    int totalrar = 0;
+
+    for (int i = 0; i < ntable; i++)
+    {
+        if (veto(table.values[i]))
+            continue;
+
+        valid[nvalid].value = table.values[i];
+        valid[nvalid].rarity = table.rarities[i];
+        totalrar += table.rarities[i];
         nvalid++;
     }
 
@@ -87,23 +156,18 @@ int random_picker<T, max>::probability_at(T entry,
                     const vector<random_pick_entry<T>>& weights,
                     int level, int scale)
 {
+    const random_pick_table<T> &table = table_at(weights, level);
     int totalrar = 0;
     int entry_rarity = 0;
 
-    for (const random_pick_entry<T>& pop : weights)
+    for (size_t i = 0; i < table.values.size(); i++)
     {
-        if (level < pop.minr || level > pop.maxr)
+        if (can_veto() && veto(table.values[i]))
             continue;
 
-        if (veto(pop.value))
-            continue;
-
-        int rar = rarity_at(pop, level);
-        ASSERTM(rar > 0, "Rarity %d: %d at level %d", rar, pop.value, level);
-
-        if (entry == pop.value)
-            entry_rarity += rar;
-        totalrar += rar;
+        if (entry == table.values[i])
+            entry_rarity += table.rarities[i];
+        totalrar += table.rarities[i];
     }
 
     if (totalrar == 0)
@@ -0,0 +1,550 @@
+/**
+ * @file
+ * @brief Recording and headless replay of a game's keystrokes.
+ *
+ * A recording is a file of JSON lines. The first describes the game:
+ *
+ *     {"replay": 1, "version": "...", "seed": "...", "name": "...",
+ *      "type": <game_type>, "species": "Hu", "job": "Fi",
+ *      "weapon": <weapon_type>, "map": "...", "rc": "<options file text>",
+ *      "macros": "<macro file text>"}
+ *
+ * and each one after that holds the keys read during one player turn, the
+ * turn count at its end, and a digest of the game state at that point:
+ *
+ *     {"turn": 12, "keys": [104, 104], "digest": "..."}
+ *
+ * A final line without a turn holds any keys read after the last turn.
+ * Bones differ between hosts, so games being recorded or replayed don't use
+ * them.
+ *
+ * Replaying (-replay <file>) starts the same character with the same seed,
+ * options and macros in headless mode, without saving, and feeds it the
+ * recorded keys. After each turn it checks the state digest against the
+ * recording, stopping with an error if they differ, and prints a JSON line
+ * with the turn's wall clock time and, where the C library can tell us, the
+ * change in heap usage. A summary line is printed when the recording runs out.
+**/
+
+#include "AppHdr.h"
+
+#include "replay.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#ifdef __GLIBC__
+# include <malloc.h>
+#endif
+
+#include "cio.h"
+#include "end.h"
+#include "files.h"
+#include "initfile.h"
+#include "jobs.h"
+#include "json-wrapper.h"
+#include "level-id.h"
+#include "libutil.h"
+#include "macro.h"
+#include "message.h"
+#include "newgame-def.h"
+#include "options.h"
+#include "player.h"
+#include "random.h"
+#include "species.h"
+#include "state.h"
+#include "stringutil.h"
+#include "syscalls.h"
+#include "version.h"
+
+namespace replay
+{
+    string record_file;
+    string replay_file;
+
+    struct recorded_turn
+    {
+        int turn = -1; // -1 for the keys after the last turn
+        vector<int> keys;
+        string digest;
+    };
+
+    // Recording.
+    static FILE *record_out = nullptr;
+    // Written out once the macros it includes are loaded.
+    static JsonNode *pending_header = nullptr;
+    static vector<int> turn_keys;
+
+    // Replaying.
+    static vector<recorded_turn> recorded;
+    static size_t replay_turn = 0;
+    static size_t replay_key = 0;
+    static bool replay_started = false;
+    static string recorded_version;
+
+    typedef chrono::steady_clock replay_clock;
+    static replay_clock::time_point turn_start;
+    static replay_clock::time_point replay_start;
+    static int64_t turn_heap = 0;
+    static int64_t replayed_keys = 0;
+
+    bool replaying()
+    {
+        return !replay_file.empty();
+    }
+
+    bool bones_disabled()
+    {
+        // Not just record_out: the first level is built before the
+        // recording starts.
+        return !record_file.empty() || replaying();
+    }
+
+    string macro_file()
+    {
+        return replay_file + ".macro.txt";
+    }
+
+    // A digest of the parts of the game state that a faithful replay must
+    // reproduce. The UI and system-specific generators are left out, since
+    // those may legitimately differ between the recording and the replay.
+    static string _state_digest()
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        auto mix = [&hash](int64_t value)
+        {
+            for (int i = 0; i < 8; i++, value >>= 8)
+            {
+                hash ^= value & 0xff;
+                hash *= 1099511628211ULL;
+            }
+        };
+
+        mix(you.num_turns);
+        mix(you.elapsed_time);
+        mix(you.where_are_you);
+        mix(you.depth);
+        mix(you.pos().x);
+        mix(you.pos().y);
+        mix(you.hp);
+        mix(you.experience);
+        const vector<uint64_t> states = rng::get_states();
+        for (size_t i = 0; i < states.size(); i++)
+            if (i != rng::UI && i != rng::SYSTEM_SPECIFIC)
+                mix(states[i]);
+        return make_stringf("%016" PRIx64, hash);
+    }
+
+    static int64_t _heap_in_use()
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+        return mallinfo2().uordblks;
+#else
+        return 0;
+#endif
+    }
+
+    static string _read_file(const string &filename)
+    {
+        string text;
+        FILE *f = fopen_u(filename.c_str(), "rb");
+        if (!f)
+            return text;
+        char buf[4096];
+        size_t len;
+        while ((len = fread(buf, 1, sizeof(buf), f)) > 0)
+            text.append(buf, len);
+        fclose(f);
+        return text;
+    }
+
+    static void _write_line(FILE *f, JsonNode *node)
+    {
+        JsonWrapper line(node);
+        fprintf(f, "%s\n", line.to_string().c_str());
+        fflush(f);
+    }
+
+    static JsonNode *_keys_json(const vector<int> &keys)
+    {
+        JsonNode *array = json_mkarray();
+        for (int key : keys)
+            json_append_element(array, json_mknumber(key));
+        return array;
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // Recording
+
+    // The file that an "include = file" line in parent names, or "" if the
+    // line is something else or the file can't be found.
+    static string _included_file(const string &line, const string &parent)
+    {
+        const string opt = trimmed_string(line);
+        if (!starts_with(opt, "include"))
+            return "";
+        const string rest = trimmed_string(opt.substr(strlen("include")));
+        if (rest.empty() || rest[0] != '=')
+            return "";
+        try
+        {
+            return base_game_options::resolve_include(
+                parent, trimmed_string(rest.substr(1)), &SysEnv.rcdirs);
+        }
+        catch (const unsafe_path &)
+        {
+            return "";
+        }
+    }
+
+    // The options with every include replaced by the contents of the file,
+    // so that the replay doesn't depend on the files around the recording.
+    // As with include itself, each file is only read once; lines naming
+    // files that can't be found are kept, to give the same errors.
+    static string _expand_includes(const string &text, const string &parent,
+                                   set<string> &included)
+    {
+        string expanded;
+        for (const string &line : split_string("\n", text, false, true))
+        {
+            const string file = _included_file(line, parent);
+            if (file.empty())
+                expanded += line + "\n";
+            else if (included.insert(file).second)
+            {
+                expanded += _expand_includes(_read_file(file), file,
+                                             included);
+            }
+        }
+        return expanded;
+    }
+
+    static string _recorded_options()
+    {
+        set<string> included;
+        if (!Options.filename.empty())
+            included.insert(Options.filename);
+
+        string rc;
+        for (const string &opt : SysEnv.extra_opts_first)
+            rc += _expand_includes(opt, Options.filename, included);
+        if (!Options.filename.empty())
+        {
+            rc += _expand_includes(_read_file(Options.filename),
+                                   Options.filename, included);
+        }
+        for (const string &opt : SysEnv.extra_opts_last)
+            rc += _expand_includes(opt, Options.filename, included);
+        return rc;
+    }
+
+    static void _start_recording(const newgame_def &ng)
+    {
+        record_out = fopen_u(record_file.c_str(), "w");
+        if (!record_out)
+        {
+            mprf(MSGCH_ERROR, "Unable to record keys to %s: %s",
+                 record_file.c_str(), strerror(errno));
+            return;
+        }
+
+        JsonNode *header = json_mkobject();
+        json_append_member(header, "replay", json_mknumber(1));
+        json_append_member(header, "version", json_mkstring(Version::Long));
+        json_append_member(header, "seed",
+                           json_mkstring(make_stringf("%" PRIu64,
+                                                      crawl_state.seed)));
+        json_append_member(header, "name", json_mkstring(ng.name));
+        json_append_member(header, "type", json_mknumber(ng.type));
+        json_append_member(header, "species",
+                           json_mkstring(species::get_abbrev(ng.species)));
+        json_append_member(header, "job",
+                           json_mkstring(get_job_abbrev(ng.job)));
+        json_append_member(header, "weapon", json_mknumber(ng.weapon));
+        json_append_member(header, "map", json_mkstring(ng.map));
+        json_append_member(header, "rc", json_mkstring(_recorded_options()));
+        pending_header = header;
+    }
+
+    static void _write_header()
+    {
+        json_append_member(pending_header, "macros",
+                           json_mkstring(macro_file_text()));
+        _write_line(record_out, pending_header);
+        pending_header = nullptr;
+    }
+
+    void macros_loaded()
+    {
+        if (pending_header)
+            _write_header();
+    }
+
+    int record_key(int key)
+    {
+        if (record_out)
+            turn_keys.push_back(key);
+        return key;
+    }
+
+    static void _record_turn(bool last)
+    {
+        if (pending_header)
+            _write_header();
+        JsonNode *line = json_mkobject();
+        if (!last)
+            json_append_member(line, "turn", json_mknumber(you.num_turns));
+        json_append_member(line, "keys", _keys_json(turn_keys));
+        if (!last)
+            json_append_member(line, "digest", json_mkstring(_state_digest()));
+        _write_line(record_out, line);
+        turn_keys.clear();
+    }
+
+    /////////////////////////////////////////////////////////////////////
+    // Replaying
+
+    NORETURN static void _bad_recording(const string &why)
+    {
+        end(1, false, "Can't replay %s: %s", replay_file.c_str(),
+            why.c_str());
+    }
+
+    static string _string_member(const JsonNode *obj, const char *key)
+    {
+        const JsonNode *member = json_find_member(obj, key);
+        if (!member || member->tag != JSON_STRING)
+            _bad_recording(make_stringf("bad or missing \"%s\"", key));
+        return member->string_;
+    }
+
+    static int _number_member(const JsonNode *obj, const char *key)
+    {
+        const JsonNode *member = json_find_member(obj, key);
+        if (!member || member->tag != JSON_NUMBER)
+            _bad_recording(make_stringf("bad or missing \"%s\"", key));
+        return member->number_;
+    }
+
+    static void _load_turns(const vector<string> &lines)
+    {
+        recorded.clear();
+        for (size_t i = 1; i < lines.size(); i++)
+        {
+            if (lines[i].empty())
+                continue;
+            JsonWrapper line(json_decode(lines[i].c_str()));
+            if (!line.node || line->tag != JSON_OBJECT)
+                _bad_recording(make_stringf("bad line %d", (int) i + 1));
+
+            recorded_turn turn;
+            if (json_find_member(line.node, "turn"))
+            {
+                turn.turn = _number_member(line.node, "turn");
+                turn.digest = _string_member(line.node, "digest");
+            }
+            const JsonNode *keys = json_find_member(line.node, "keys");
+            if (!keys || keys->tag != JSON_ARRAY)
+                _bad_recording(make_stringf("bad keys on line %d", (int) i + 1));
+            const JsonNode *key;
+            json_foreach(key, keys)
+            {
+                if (key->tag != JSON_NUMBER)
+                    _bad_recording(make_stringf("bad key on line %d",
+                                                (int) i + 1));
+                turn.keys.push_back(key->number_);
+            }
+            recorded.push_back(turn);
+        }
+        if (recorded.empty())
+            _bad_recording("no keys were recorded");
+    }
+
+    void load(bool rc_only)
+    {
+        const vector<string> lines = split_string("\n",
+                                                  _read_file(replay_file));
+        if (lines.empty())
+            _bad_recording("empty or unreadable");
+
+        JsonWrapper header(json_decode(lines[0].c_str()));
+        if (!header.node || header->tag != JSON_OBJECT
+            || !json_find_member(header.node, "replay"))
+        {
+            _bad_recording("not a key recording");
+        }
+
+        if (rc_only)
+        {
+            // Play with the recorded options, and nothing else.
+            const string rc_file = replay_file + ".rc";
+            FILE *rc = fopen_u(rc_file.c_str(), "w");
+            if (!rc)
+                _bad_recording("can't write " + rc_file);
+            fputs(_string_member(header.node, "rc").c_str(), rc);
+            fclose(rc);
+            SysEnv.crawl_rc = rc_file;
+            SysEnv.extra_opts_first.clear();
+            SysEnv.extra_opts_last.clear();
+
+            FILE *macros = fopen_u(macro_file().c_str(), "w");
+            if (!macros)
+                _bad_recording("can't write " + macro_file());
+            fputs(_string_member(header.node, "macros").c_str(), macros);
+            fclose(macros);
+            return;
+        }
+
+        recorded_version = _string_member(header.node, "version");
+        uint64_t seed;
+        if (sscanf(_string_member(header.node, "seed").c_str(),
+                   "%" SCNu64, &seed) != 1)
+        {
+            _bad_recording("bad seed");
+        }
+
+        newgame_def &game = Options.game;
+        game.name = _string_member(header.node, "name");
+        game.type = static_cast<game_type>(_number_member(header.node,
+                                                          "type"));
+        // A custom seed game is a normal game with a seed from the options,
+        // which skips the seed menu; setup_game() makes it a custom seed
+        // game again. Other games keep the seed without changing type.
+        if (game.type == GAME_TYPE_CUSTOM_SEED)
+        {
+            game.type = GAME_TYPE_NORMAL;
+            Options.seed_from_rc = seed;
+        }
+        game.species = species::from_abbrev(
+                            _string_member(header.node, "species").c_str());
+        game.job = get_job_by_abbrev(
+                            _string_member(header.node, "job").c_str());
+        game.weapon = static_cast<weapon_type>(
+                            _number_member(header.node, "weapon"));
+        game.map = _string_member(header.node, "map");
+        game.fully_random = false;
+        Options.seed = seed;
+        Options.name_bypasses_menu = true;
+        // Never touch the real save, if there is one.
+        Options.no_save = true;
+        crawl_state.default_startup_name = game.name;
+
+        _load_turns(lines);
+    }
+
+    void game_started(const newgame_def &ng)
+    {
+        if (!record_file.empty() && !replaying())
+            _start_recording(ng);
+        if (replaying())
+        {
+            replay_started = true;
+            replay_start = turn_start = replay_clock::now();
+            turn_heap = _heap_in_use();
+        }
+    }
+
+    static void _print_summary(bool diverged)
+    {
+        replay_started = false;
+        const int64_t usecs = chrono::duration_cast<chrono::microseconds>(
+                                replay_clock::now() - replay_start).count();
+        JsonNode *summary = json_mkobject();
+        json_append_member(summary, "result",
+                           json_mkstring(diverged ? "diverged" : "ok"));
+        json_append_member(summary, "recorded_version",
+                           json_mkstring(recorded_version));
+        json_append_member(summary, "version", json_mkstring(Version::Long));
+        json_append_member(summary, "turns", json_mknumber(you.num_turns));
+        json_append_member(summary, "keys", json_mknumber(replayed_keys));
+        json_append_member(summary, "usecs", json_mknumber(usecs));
+        _write_line(stdout, summary);
+    }
+
+    NORETURN static void _diverged(const string &why)
+    {
+        _print_summary(true);
+        end(1, false, "Replay diverged at turn %d: %s", you.num_turns,
+            why.c_str());
+    }
+
+    NORETURN static void _replay_done()
+    {
+        _print_summary(false);
+        end(0);
+    }
+
+    int next_key()
+    {
+        // Nothing should need keys before the game starts.
+        if (!replay_started)
+            return ESCAPE;
+
+        const recorded_turn &turn = recorded[replay_turn];
+        if (replay_key < turn.keys.size())
+        {
+            replayed_keys++;
+            return turn.keys[replay_key++];
+        }
+        if (replay_turn + 1 < recorded.size())
+            _diverged("the game wanted more keys than were recorded");
+        _replay_done();
+    }
+
+    void turn_done()
+    {
+        if (record_out)
+            _record_turn(false);
+
+        if (!replay_started)
+            return;
+
+        const recorded_turn &turn = recorded[replay_turn];
+        if (turn.turn != you.num_turns)
+        {
+            _diverged(make_stringf("expected turn %d to be next",
+                                   turn.turn));
+        }
+        if (replay_key != turn.keys.size())
+        {
+            _diverged(make_stringf("the turn took %d keys, not %d",
+                                   (int) replay_key, (int) turn.keys.size()));
+        }
+        if (turn.digest != _state_digest())
+            _diverged("the game state differs");
+
+        const auto now = replay_clock::now();
+        const int64_t heap = _heap_in_use();
+        JsonNode *line = json_mkobject();
+        json_append_member(line, "turn", json_mknumber(you.num_turns));
+        json_append_member(line, "place",
+                           json_mkstring(level_id::current().describe()));
+        json_append_member(line, "keys", json_mknumber(replay_key));
+        json_append_member(line, "usecs",
+            json_mknumber(chrono::duration_cast<chrono::microseconds>(
+                              now - turn_start).count()));
+        json_append_member(line, "heap_delta",
+                           json_mknumber(heap - turn_heap));
+        _write_line(stdout, line);
+
+        turn_start = now;
+        turn_heap = heap;
+        replay_turn++;
+        replay_key = 0;
+        if (replay_turn == recorded.size())
+            _replay_done();
+    }
+
+    void game_ended()
+    {
+        if (record_out)
+        {
+            _record_turn(true);
+            fclose(record_out);
+            record_out = nullptr;
+        }
+        // The recording may end with the game, but shouldn't go on past it.
+        if (replaying() && replay_started)
+            _print_summary(replay_turn + 1 < recorded.size());
+    }
+}
@@ -0,0 +1,49 @@
+/**
+ * @file
+ * @brief Recording and headless replay of a game's keystrokes.
+**/
+
+#pragma once
+
+#include <string>
+
+using std::string;
+
+struct newgame_def;
+
+namespace replay
+{
+    // Set by the -record-keys command line option: new games record their
+    // seed, character and options, then every key read, to this file.
+    extern string record_file;
+    // Set by the -replay command line option: the recording to replay.
+    extern string replay_file;
+
+    bool replaying();
+    // Whether other games' bones are left out: a recording can't reproduce
+    // the ghosts the recording host happened to have, so neither recording
+    // nor replaying places them, and replays don't leave any behind.
+    bool bones_disabled();
+
+    // Read the recording named by replay_file. With rc_only, just set up the
+    // recorded options file; otherwise set up the recorded game.
+    void load(bool rc_only);
+
+    // Called once a new game has been set up, before the player acts.
+    void game_started(const newgame_def &ng);
+    // Called once the macros and keymaps are loaded.
+    void macros_loaded();
+    // The file the recorded macros are written to, for the replay to use
+    // instead of the player's own.
+    string macro_file();
+
+    // Called for every key read from the terminal, returning it.
+    int record_key(int key);
+    // The next recorded key, when replaying.
+    int next_key();
+
+    // Called at the end of every player turn.
+    void turn_done();
+    // Called when the game ends or is saved.
+    void game_ended();
+}
@@ -154,6 +154,9 @@ static spell_name_map &_get_spell_name_cache()
 void init_spell_name_cache()
 {
     spell_name_map &cache = _get_spell_name_cache();
+    if (!cache.empty())
+        return;
+
     for (int i = 0; i < NUM_SPELLS; i++)
     {
         spell_type type = static_cast<spell_type>(i);
@@ -13,6 +13,7 @@
 #include "command.h"
 #include "coordit.h"
 #include "ctest.h"
+#include "data-image.h"
 #include "database.h"
 #include "dbg-maps.h"
 #include "dbg-objstat.h"
@@ -43,6 +44,7 @@
 #include "notes.h"
 #include "output.h"
 #include "player-save-info.h"
+#include "replay.h"
 #include "shopping.h"
 #include "skills.h"
 #include "spl-book.h"
@@ -80,6 +82,39 @@ static void _loading_message(string m)
 }
 
 // Initialise a whole lot of stuff...
+// Set when the dungeon Lua and maps for the first game have already been
+// loaded by preload_game_data().
+static bool _game_data_preloaded = false;
+
+/**
+ * Do the expensive part of startup that doesn't depend on the player or
+ * their options, ahead of time, so that the first _initialize() can skip it.
+ * Used by the zygote launch mode, which forks already-initialised children.
+ */
+void preload_game_data()
+{
+    init_spell_descs();
+    init_mon_name_cache();
+    init_mons_spells();
+    init_spell_name_cache();
+    init_feat_desc_cache();
+
+    init_dungeon_lua();
+
+    // Bring the database files up to date and map them. The mappings are
+    // read-only, so every child can share them.
+    databaseSystemInit();
+
+    read_maps();
+    run_map_global_preludes();
+    crawl_state.use_des_cache = true;
+
+    data_image::open();
+    init_rays();
+
+    _game_data_preloaded = true;
+}
+
 static void _initialize()
 {
     Options.fixup_options();
@@ -103,9 +138,8 @@ static void _initialize()
     init_mons_spells();
     init_parchment_overlays();
 
-    // init_item_name_cache() needs to be redone after init_char_table()
-    // and init_show_table() have been called, so that the glyphs will
-    // be set to use with item_names_by_glyph_cache.
+    // The item glyph index must be rebuilt after init_char_table() and
+    // init_show_table() have been called, so that it uses the right glyphs.
     init_item_name_cache();
 
     unwind_bool no_more(crawl_state.show_more_prompt, false);
@@ -126,7 +160,8 @@ static void _initialize()
     you.unique_items.init(UNIQ_NOT_EXISTS);
 
     // Set up the Lua interpreter for the dungeon builder.
-    init_dungeon_lua();
+    if (!_game_data_preloaded)
+        init_dungeon_lua();
 
 #ifdef USE_TILE_LOCAL
     // Draw the splash screen before the database gets initialised as that
@@ -139,17 +174,25 @@ static void _initialize()
     _loading_message("Loading databases...");
     databaseSystemInit();
 
-    _loading_message("Loading spells and features...");
-    init_feat_desc_cache();
+    // Map the shared tables, building any that are missing or stale.
+    data_image::open();
+    init_rays();
+
+    // The feature description cache is built on first lookup.
+    _loading_message("Loading spells...");
     init_spell_name_cache();
 #ifdef DEBUG
     validate_spellbooks();
 #endif
 
     // Read special levels and vaults.
-    _loading_message("Loading maps...");
-    read_maps();
-    run_map_global_preludes();
+    if (!_game_data_preloaded)
+    {
+        _loading_message("Loading maps...");
+        read_maps();
+        run_map_global_preludes();
+    }
+    _game_data_preloaded = false;
 
     if (crawl_state.build_db)
         end(0);
@@ -1108,6 +1151,7 @@ bool startup_step()
         clear_message_store();
         setup_game(ng);
         newchar = true;
+        replay::game_started(ng);
         choice.seed = Options.seed; // kind of ugly, but may be changed during
                                     // setup_game.
         write_newgame_options_file(choice);
@@ -6,4 +6,5 @@
 #pragma once
 
 bool startup_step();
+void preload_game_data();
 void cio_init();
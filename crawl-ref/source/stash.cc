@@ -32,6 +32,7 @@
 #include "items.h"
 #include "libutil.h" // map_find
 #include "makeitem.h"
+#include "mem-usage.h"
 #include "menu.h"
 #include "message.h"
 #include "notes.h"
@@ -1071,6 +1072,30 @@ void LevelStashes::remove_shop(const coord_def& c)
         }
 }
 
+static size_t _items_memory(const vector<item_def> &items)
+{
+    size_t total = mem_usage::vector_bytes(items);
+    for (const item_def &item : items)
+        total += item.props.memory_used();
+    return total;
+}
+
+size_t LevelStashes::memory_used() const
+{
+    size_t total = mem_usage::map_bytes(m_stashes)
+                   + mem_usage::vector_bytes(m_shops);
+    for (const auto &entry : m_stashes)
+        total += _items_memory(entry.second.items);
+    for (const ShopInfo &shop : m_shops)
+    {
+        total += _items_memory(shop.shop.stock)
+                 + mem_usage::string_bytes(shop.shop.shop_name)
+                 + mem_usage::string_bytes(shop.shop.shop_type_name)
+                 + mem_usage::string_bytes(shop.shop.shop_suffix_name);
+    }
+    return total;
+}
+
 LevelStashes &StashTracker::get_current_level()
 {
     return levels[level_id::current()];
@@ -1154,6 +1179,14 @@ void StashTracker::save(writer& outf) const
         entry.second.save(outf);
 }
 
+size_t StashTracker::memory_used() const
+{
+    size_t total = mem_usage::map_bytes(levels);
+    for (const auto &entry : levels)
+        total += entry.second.memory_used();
+    return total;
+}
+
 void StashTracker::load(reader& inf)
 {
     // Time of last corpse update.
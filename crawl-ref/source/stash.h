@@ -217,6 +217,9 @@ public:
     bool  is_current() const;
 
     void  remove_shop(const coord_def& c);
+
+    // Roughly how much heap memory the stashes and shops hold.
+    size_t memory_used() const;
 private:
     void _update_corpses(int rot_time);
     void _update_identification();
@@ -274,6 +277,8 @@ public:
     void dump(const char *filename, bool identify = false) const;
 
     void remove_shop(const level_pos &pos);
+
+    size_t memory_used() const;
 private:
     void get_matching_stashes(const base_pattern &search,
                               vector<stash_search_result> &results,
@@ -11,6 +11,7 @@
 #include <algorithm>
 
 #include "dlua.h"
+#include "mem-usage.h"
 #include "monster.h"
 #include "stringutil.h"
 #include "tag-version.h"
@@ -426,6 +427,46 @@ store_val_type CrawlStoreValue::get_type() const
     return type;
 }
 
+size_t CrawlStoreValue::memory_used() const
+{
+    if (flags & SFLAG_UNSET)
+        return 0;
+
+    switch (type)
+    {
+    case SV_STR:
+        return sizeof(string)
+               + mem_usage::string_bytes(*static_cast<string*>(val.ptr));
+    case SV_COORD:
+        return sizeof(coord_def);
+    case SV_ITEM:
+        return sizeof(item_def)
+               + static_cast<item_def*>(val.ptr)->props.memory_used();
+    case SV_HASH:
+        return sizeof(CrawlHashTable)
+               + static_cast<CrawlHashTable*>(val.ptr)->memory_used();
+    case SV_VEC:
+        return sizeof(CrawlVector)
+               + static_cast<CrawlVector*>(val.ptr)->memory_used();
+    case SV_LEV_ID:
+        return sizeof(level_id);
+    case SV_LEV_POS:
+        return sizeof(level_pos);
+    case SV_MONST:
+        return sizeof(monster)
+               + static_cast<monster*>(val.ptr)->props.memory_used();
+    case SV_LUA:
+    {
+        const dlua_chunk &chunk = *static_cast<dlua_chunk*>(val.ptr);
+        return sizeof(dlua_chunk)
+               + mem_usage::string_bytes(chunk.lua_string())
+               + mem_usage::string_bytes(chunk.compiled_chunk());
+    }
+    default:
+        return 0;
+    }
+}
+
 //////////////////////////////
 // Read/write from/to savefile
 void CrawlStoreValue::write(writer &th) const
@@ -1269,6 +1310,15 @@ bool CrawlHashTable::exists(const string &key) const
     return find(key) != end();
 }
 
+size_t CrawlHashTable::memory_used() const
+{
+    size_t total = mem_usage::map_bytes(*this);
+    for (const auto &entry : *this)
+        total += mem_usage::string_bytes(entry.first)
+                 + entry.second.memory_used();
+    return total;
+}
+
 void CrawlHashTable::assert_validity() const
 {
 #ifdef DEBUG
@@ -1501,6 +1551,14 @@ store_val_type CrawlVector::get_type() const
     return type;
 }
 
+size_t CrawlVector::memory_used() const
+{
+    size_t total = mem_usage::vector_bytes(vec);
+    for (const CrawlStoreValue &value : vec)
+        total += value.memory_used();
+    return total;
+}
+
 void CrawlVector::assert_validity() const
 {
 #ifdef DEBUG
@@ -101,6 +101,9 @@ public:
 
     CrawlStoreValue &operator = (const CrawlStoreValue &other);
 
+    // Roughly how much heap memory the value owns.
+    size_t memory_used() const;
+
 protected:
     // These first two fields need to match those in CrawlVector
     store_val_type type:8;
@@ -252,6 +255,7 @@ public:
     bool exists(const string &key) const;
 
     void assert_validity() const;
+    size_t memory_used() const;
 
     // NOTE: If the const versions of get_value() or [] are given a
     // key which doesn't exist, they will assert.
@@ -315,6 +319,7 @@ public:
     store_flags    unset_default_flags(store_flags flags);
     store_val_type get_type() const;
     void           assert_validity() const;
+    size_t         memory_used() const;
     void           set_max_size(vec_size size);
     vec_size       get_max_size() const;
 
@@ -5783,9 +5783,9 @@ static void _tag_construct_level(writer &th)
 
     // how many clouds?
     marshallShort(th, env.cloud.size());
-    for (const auto& entry : env.cloud)
+    for (const coord_def &pos : env.cloud.positions())
     {
-        const cloud_struct& cloud = entry.second;
+        const cloud_struct& cloud = *env.cloud.find(pos);
         marshallByte(th, cloud.type);
         ASSERT(cloud.type != CLOUD_NONE);
         ASSERT_IN_BOUNDS(cloud.pos);
@@ -7549,7 +7549,7 @@ static void _tag_read_level(reader &th)
         // 0.18-a0-629-g16988c9.
         if (!cell_is_solid(cloud.pos))
 #endif
-            env.cloud[cloud.pos] = cloud;
+            env.cloud.set(cloud.pos, cloud);
     }
 
     EAT_CANARY;
@@ -8399,6 +8399,8 @@ static void _tag_read_level_monsters(reader &th)
     {
         monster& m = env.mons[i];
         unmarshallMonster(th, m);
+        if (m.type != MONS_NO_MONSTER)
+            env.mon_slots.push_back(i);
 
         // place monster
         if (!m.alive())
@@ -9078,6 +9080,36 @@ vector<ghost_demon> tag_read_ghosts(reader &th)
     return global_ghosts; // should use copy semantics?
 }
 
+// Read the header of a ghost tag, and the ghost count just inside it.
+// Leaves th positioned at the first ghost.
+static int _tag_read_ghost_count(reader &th)
+{
+    const int data_size = unmarshallInt(th);
+    const int nghosts = unmarshallShort(th);
+    if (data_size < 2 || nghosts < 1 || nghosts > MAX_GHOSTS)
+    {
+        string error = "Bones file has an invalid ghost count (" +
+                                                    to_string(nghosts) + ")";
+        throw corrupted_save(error);
+    }
+    return nghosts;
+}
+
+int tag_read_ghost_count(reader &th)
+{
+    return _tag_read_ghost_count(th);
+}
+
+ghost_demon tag_read_random_ghost(reader &th)
+{
+    const int chosen = random2(_tag_read_ghost_count(th));
+    // Ghosts are variable length, so those before the chosen one still need
+    // to be read through; those after it don't.
+    for (int i = 0; i < chosen; ++i)
+        _unmarshallGhost(th);
+    return _unmarshallGhost(th);
+}
+
 void tag_write_ghosts(writer &th, const vector<ghost_demon> &ghosts)
 {
     global_ghosts = ghosts;
@@ -209,6 +209,11 @@ player_save_info tag_read_char_info(reader &th, uint8_t format, uint8_t major,
 
 vector<ghost_demon> tag_read_ghosts(reader &th);
 void tag_write_ghosts(writer &th, const vector<ghost_demon> &ghosts);
+// Read just the number of ghosts in a ghost tag.
+int tag_read_ghost_count(reader &th);
+// Read one ghost, chosen at random, from a ghost tag; the rest of the tag is
+// left unread.
+ghost_demon tag_read_random_ghost(reader &th);
 
 /* ***********************************************************************
  * misc
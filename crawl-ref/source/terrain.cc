@@ -1783,8 +1783,12 @@ void fall_into_a_pool(dungeon_feature_type terrain)
 typedef map<string, dungeon_feature_type> feat_desc_map;
 static feat_desc_map feat_desc_cache;
 
+// Built on first use; feature descriptions don't change during a game.
 void init_feat_desc_cache()
 {
+    if (!feat_desc_cache.empty())
+        return;
+
     for (int i = 0; i < NUM_FEATURES; i++)
     {
         dungeon_feature_type feat = static_cast<dungeon_feature_type>(i);
@@ -1807,6 +1811,7 @@ dungeon_feature_type feat_by_desc(string desc)
         return DNGN_DRY_FOUNTAIN;
 #endif
 
+    init_feat_desc_cache();
     return lookup(feat_desc_cache, desc, DNGN_UNSEEN);
 }
 
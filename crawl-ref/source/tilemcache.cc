@@ -3,6 +3,8 @@
 #ifdef USE_TILE
 #include "tilemcache.h"
 
+#include <typeinfo>
+
 #include "colour.h"
 #include "env.h"
 #include "libutil.h"
@@ -11,6 +13,7 @@
 #include "mon-util.h"
 #include "mutant-beast.h"
 #include "options.h"
+#include "profiler.h"
 #include "tile-flags.h"
 #include "rltiles/tiledef-player.h"
 #include "tiledoll.h"
@@ -157,9 +160,74 @@ mcache_manager::~mcache_manager()
     clear_all();
 }
 
+// A hash of everything an entry gives its users: its type, draw info,
+// doll and transparency.
+static size_t _mcache_content_hash(const mcache_entry &entry)
+{
+    size_t hash = typeid(entry).hash_code();
+    const auto mix = [&hash](size_t v)
+    {
+        hash ^= v + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+
+    tile_draw_info dinfo[mcache_entry::MAX_INFO_COUNT];
+    const int count = entry.info(&dinfo[0]);
+    mix(count);
+    for (int i = 0; i < count; i++)
+    {
+        mix(dinfo[i].idx);
+        mix(dinfo[i].ofs_x);
+        mix(dinfo[i].ofs_y);
+    }
+
+    if (const dolls_data *doll = entry.doll())
+        for (int i = 0; i < TILEP_PART_MAX; i++)
+            mix(doll->parts[i]);
+
+    mix(entry.transparent());
+    return hash;
+}
+
+static bool _mcache_same_content(const mcache_entry &a, const mcache_entry &b)
+{
+    if (typeid(a) != typeid(b) || a.transparent() != b.transparent())
+        return false;
+
+    const dolls_data *a_doll = a.doll();
+    const dolls_data *b_doll = b.doll();
+    if (!a_doll != !b_doll || a_doll && *a_doll != *b_doll)
+        return false;
+
+    tile_draw_info a_info[mcache_entry::MAX_INFO_COUNT];
+    tile_draw_info b_info[mcache_entry::MAX_INFO_COUNT];
+    const int count = a.info(&a_info[0]);
+    if (b.info(&b_info[0]) != count)
+        return false;
+    for (int i = 0; i < count; i++)
+    {
+        if (a_info[i].idx != b_info[i].idx
+            || a_info[i].ofs_x != b_info[i].ofs_x
+            || a_info[i].ofs_y != b_info[i].ofs_y)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The index of an existing entry that draws the same as this one, or ~0.
+tileidx_t mcache_manager::find_same(const mcache_entry &entry,
+                                    size_t hash) const
+{
+    const auto range = m_by_content.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+        if (_mcache_same_content(entry, *m_entries[it->second]))
+            return it->second;
+    return ~0;
+}
+
 tileidx_t mcache_manager::register_monster(const monster_info& minf)
 {
-    // TODO enne - is it worth it to search against all mcache entries?
     // TODO enne - pool mcache types to avoid too much alloc/dealloc?
 
     mcache_entry *entry;
@@ -186,7 +254,18 @@ tileidx_t mcache_manager::register_monster(const monster_info& minf)
     else
         return 0;
 
-    tileidx_t idx = ~0;
+    // Most monsters look the same from one turn to the next, and many
+    // look like each other; share their entries rather than piling up
+    // new ones until the next clear_nonref().
+    const size_t hash = _mcache_content_hash(*entry);
+    tileidx_t idx = find_same(*entry, hash);
+    if (idx != (tileidx_t)~0)
+    {
+        profiler::count(PROF_COUNTER, "mcache entries shared");
+        delete entry;
+        return TILEP_MCACHE_START + idx;
+    }
+    profiler::count(PROF_COUNTER, "mcache entries created");
 
     for (tileidx_t i = 0; i < (tileidx_t)m_entries.size(); i++)
     {
@@ -203,25 +282,32 @@ tileidx_t mcache_manager::register_monster(const monster_info& minf)
         idx = (tileidx_t)m_entries.size();
         m_entries.push_back(entry);
     }
+    m_by_content.emplace(hash, idx);
 
     return TILEP_MCACHE_START + idx;
 }
 
 void mcache_manager::clear_nonref()
 {
-    for (mcache_entry *&entry : m_entries)
+    for (auto it = m_by_content.begin(); it != m_by_content.end();)
     {
-        if (!entry || entry->ref_count() > 0)
+        mcache_entry *&entry = m_entries[it->second];
+        if (entry->ref_count() > 0)
+        {
+            ++it;
             continue;
+        }
 
         delete entry;
         entry = nullptr;
+        it = m_by_content.erase(it);
     }
 }
 
 void mcache_manager::clear_all()
 {
     deleteAll(m_entries);
+    m_by_content.clear();
 }
 
 mcache_entry *mcache_manager::get(tileidx_t idx)
@@ -6,6 +6,7 @@
 #ifdef USE_TILE
 #pragma once
 
+#include <unordered_map>
 #include <vector>
 
 struct dolls_data;
@@ -74,6 +75,11 @@ public:
 
 protected:
     vector<mcache_entry*> m_entries;
+    // Entry indices by a hash of what the entry draws, so that monsters
+    // that look the same share a single entry.
+    unordered_multimap<size_t, tileidx_t> m_by_content;
+
+    tileidx_t find_same(const mcache_entry &entry, size_t hash) const;
 };
 
 // The global monster cache.
@@ -35,6 +35,7 @@
 #include "libutil.h"
 #include "macro.h"
 #include "map-knowledge.h"
+#include "mem-usage.h"
 #include "menu.h"
 #include "outer-menu.h"
 #include "message.h"
@@ -45,6 +46,7 @@
 #include "output.h"
 #include "player.h"
 #include "player-equip.h"
+#include "profiler.h"
 #include "religion.h"
 #include "scroller.h"
 #include "showsymb.h"
@@ -622,6 +624,21 @@ wint_t TilesFramework::_handle_control_message(sockaddr_un addr, string data)
         // (possibly just as a string, like the lua API for this)
         process_command(CMD_GAME_MENU);
     }
+    else if (msgtype == "turn_profile")
+    {
+        // Anyone watching may read the profile, but only the player (or a
+        // wizard) turns it on or off. When the game isn't controlled from
+        // the web, everyone on the socket is a spectator.
+        JsonWrapper enable = json_find_member(obj.node, "enable");
+        if (enable.node && (m_controlled_from_web || you.wizard))
+        {
+            enable.check(JSON_BOOL);
+            profiler::enabled = enable->bool_;
+        }
+        send_turn_profile();
+    }
+    else if (msgtype == "memory_report")
+        send_memory_report();
     else if (msgtype == "text_input")
     {
         JsonWrapper text = json_find_member(obj.node, "text");
@@ -793,6 +810,27 @@ void TilesFramework::send_milestone(const xlog_fields &xl)
     finish_message();
 }
 
+void TilesFramework::send_turn_profile()
+{
+    JsonWrapper j = json_mkobject();
+    json_append_member(j.node, "msg", json_mkstring("turn_profile"));
+    json_append_member(j.node, "enabled", json_mkbool(profiler::enabled));
+    json_append_member(j.node, "entries", profiler::to_json());
+    write_message("*");
+    write_message("%s", j.to_string().c_str());
+    finish_message();
+}
+
+void TilesFramework::send_memory_report()
+{
+    JsonWrapper j = json_mkobject();
+    json_append_member(j.node, "msg", json_mkstring("memory_report"));
+    json_append_member(j.node, "report", mem_usage::to_json());
+    write_message("*");
+    write_message("%s", j.to_string().c_str());
+    finish_message();
+}
+
 void TilesFramework::send_options()
 {
     json_open_object();
@@ -1882,26 +1920,90 @@ void TilesFramework::_send_cursor(cursor_type type)
     }
 }
 
+static void _mcache_ref_cell(const screen_cell_t &cell, bool inc)
+{
+    int fg_idx = cell.tile.fg.tile();
+    if (fg_idx >= TILEP_MCACHE_START)
+    {
+        mcache_entry *entry = mcache.get(fg_idx);
+        if (entry)
+        {
+            if (inc)
+                entry->inc_ref();
+            else
+                entry->dec_ref();
+        }
+    }
+}
+
 void TilesFramework::_mcache_ref(bool inc)
 {
     for (int y = 0; y < GYM; y++)
         for (int x = 0; x < GXM; x++)
-        {
-            coord_def gc(x, y);
+            _mcache_ref_cell(m_current_view(coord_def(x, y)), inc);
+}
 
-            int fg_idx = m_current_view(gc).tile.fg.tile();
-            if (fg_idx >= TILEP_MCACHE_START)
-            {
-                mcache_entry *entry = mcache.get(fg_idx);
-                if (entry)
-                {
-                    if (inc)
-                        entry->inc_ref();
-                    else
-                        entry->dec_ref();
-                }
-            }
-        }
+// Would _send_cell() have anything to say about the change from current to
+// next? Errs on the side of yes: cells with monsters or the player always
+// count as changed, since what's sent for them depends on more than the
+// cell itself.
+static bool _cell_changed(const screen_cell_t &current_sc,
+                          const screen_cell_t &next_sc,
+                          const map_cell &current_mc, const map_cell &next_mc)
+{
+    if (current_mc.monsterinfo() || next_mc.monsterinfo()
+        || next_sc.tile.fg.tile() == TILEP_PLAYER)
+    {
+        return true;
+    }
+
+    if (current_mc.feat() != next_mc.feat()
+        || get_cell_map_feature(current_mc) != get_cell_map_feature(next_mc))
+    {
+        return true;
+    }
+
+    if (current_sc.glyph != next_sc.glyph
+        || current_sc.colour != next_sc.colour
+        || current_sc.flash_colour != next_sc.flash_colour
+        || current_sc.flash_alpha != next_sc.flash_alpha)
+    {
+        return true;
+    }
+
+    // Everything in packed_cell::operator== but the map knowledge, which
+    // that compares by address.
+    const packed_cell &cur = current_sc.tile;
+    const packed_cell &next = next_sc.tile;
+    if (cur.fg != next.fg || cur.bg != next.bg || cur.cloud != next.cloud
+        || cur.icons != next.icons
+        || cur.flv.floor != next.flv.floor
+        || cur.flv.special != next.flv.special
+        || cur.is_bloody != next.is_bloody
+        || cur.old_blood != next.old_blood
+        || cur.is_silenced != next.is_silenced
+        || cur.halo != next.halo
+        || cur.is_highlighted_summoner != next.is_highlighted_summoner
+        || cur.is_sanctuary != next.is_sanctuary
+        || cur.is_blasphemy != next.is_blasphemy
+        || cur.has_bfb_corpse != next.has_bfb_corpse
+        || cur.is_liquefied != next.is_liquefied
+        || cur.orb_glow != next.orb_glow
+        || cur.quad_glow != next.quad_glow
+        || cur.disjunct != next.disjunct
+        || cur.mangrove_water != next.mangrove_water
+        || cur.awakened_forest != next.awakened_forest
+        || cur.blood_rotation != next.blood_rotation
+        || cur.travel_trail != next.travel_trail
+        || cur.num_dngn_overlay != next.num_dngn_overlay)
+    {
+        return true;
+    }
+    for (int i = 0; i < next.num_dngn_overlay; ++i)
+        if (cur.dngn_overlay[i] != next.dngn_overlay[i])
+            return true;
+
+    return false;
 }
 
 void TilesFramework::_send_map(bool spectator_only)
@@ -1917,6 +2019,16 @@ void TilesFramework::_send_map(bool spectator_only)
     bool force_full = spectator_only || m_need_full_map;
     m_need_full_map = false;
 
+    // Only the cells sent are brought up to date below, so monsters in the
+    // others are still where the client last saw them.
+    if (!force_full)
+    {
+        for (const auto &loc : m_monster_locs)
+            if (!is_dirty(loc.second))
+                new_monster_locs.insert(loc);
+    }
+    vector<coord_def> sent_cells;
+
     json_open_object();
     json_write_string("msg", "map");
     json_treat_as_empty();
@@ -1985,6 +2097,7 @@ void TilesFramework::_send_map(bool spectator_only)
             }
 
             mark_clean(gc);
+            sent_cells.push_back(gc);
 
             if (m_origin.equals(-1, -1))
                 m_origin = gc;
@@ -2029,14 +2142,25 @@ void TilesFramework::_send_map(bool spectator_only)
     if (spectator_only)
         return;
 
-    if (m_mcache_ref_done)
-        _mcache_ref(false);
+    profiler::count(PROF_COUNTER, "webtiles map cells sent",
+                    sent_cells.size());
 
-    m_current_map_knowledge = env.map_knowledge;
-    m_current_view = m_next_view;
+    // Remember what the client now has, for the cells it was sent.
+    for (const coord_def &gc : sent_cells)
+    {
+        if (m_mcache_ref_done)
+            _mcache_ref_cell(m_current_view(gc), false);
+        m_current_map_knowledge(gc) = env.map_knowledge(gc);
+        m_current_view(gc) = m_next_view(gc);
+        if (m_mcache_ref_done)
+            _mcache_ref_cell(m_current_view(gc), true);
+    }
 
-    _mcache_ref(true);
-    m_mcache_ref_done = true;
+    if (!m_mcache_ref_done)
+    {
+        _mcache_ref(true);
+        m_mcache_ref_done = true;
+    }
 
     m_monster_locs = new_monster_locs;
 }
@@ -2072,6 +2196,15 @@ void TilesFramework::_send_monster(const coord_def &gc, const monster_info* m,
 
     if (last == nullptr)
         force_full = true;
+    else if (last == m && !force_full)
+    {
+        // The same snapshot as was sent before, so nothing has changed.
+        profiler::count(PROF_COUNTER, "webtiles monster snapshots unchanged");
+        if (m->is_named())
+            json_write_int("clientid", m->client_id);
+        json_close_object(true);
+        return;
+    }
 
     if (force_full || (last->full_name() != m->full_name()))
         json_write_string("name", m->full_name());
@@ -2142,7 +2275,8 @@ void TilesFramework::load_dungeon(const crawl_view_buffer &vbuf,
     m_next_view_tl = view2grid(coord_def(1, 1));
     m_next_view_br = view2grid(crawl_view.viewsz);
 
-    // Copy vbuf into m_next_view
+    // Copy vbuf into m_next_view, marking only the cells that differ from
+    // what the client already has.
     for (int y = 0; y < vbuf.size().y; y++)
         for (int x = 0; x < vbuf.size().x; x++)
         {
@@ -2158,7 +2292,12 @@ void TilesFramework::load_dungeon(const crawl_view_buffer &vbuf,
             pack_cell_overlays(grid, m_next_view);
 
             mark_clean(grid); // Remove redraw flag
-            mark_dirty(grid);
+            if (_cell_changed(m_current_view(grid), *cell,
+                              m_current_map_knowledge(grid),
+                              cell->tile.map_knowledge))
+            {
+                mark_dirty(grid);
+            }
         }
 
     m_next_gc = gc;
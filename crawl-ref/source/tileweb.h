@@ -228,6 +228,8 @@ public:
 
     void send_doll(const dolls_data &doll, bool submerged, bool ghost);
     void send_milestone(const xlog_fields &xl);
+    void send_turn_profile();
+    void send_memory_report();
     void send_options();
 
     void invalidate_item(int index);
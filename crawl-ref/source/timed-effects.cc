@@ -45,6 +45,7 @@
 #include "player.h"
 #include "player-notices.h"
 #include "player-stats.h"
+#include "profiler.h"
 #include "random.h"
 #include "religion.h"
 #include "skills.h"
@@ -623,6 +624,8 @@ void update_level(int elapsedTime)
 {
     ASSERT(!crawl_state.game_is_arena());
 
+    PROF_SCOPE(PROF_PHASE, "update_level");
+
     // Simulate up to 10 turns on the floor, then merely update durations and
     // effects for the remaining time.
     const int sim_turns = min(10, elapsedTime / 10);
@@ -46,6 +46,7 @@
 #include "longwalk-range-mode.h"
 #include "macro.h"
 #include "mapmark.h"
+#include "mem-usage.h"
 #include "menu.h"
 #include "message.h"
 #include "mon-death.h"
@@ -4532,6 +4533,21 @@ bool TravelCache::is_known_branch(uint8_t branch) const
             { return entry.second.is_known_branch(branch); });
 }
 
+size_t TravelCache::memory_used() const
+{
+    size_t total = mem_usage::map_bytes(levels);
+    for (const auto &entry : levels)
+    {
+        const LevelInfo &li = entry.second;
+        total += mem_usage::vector_bytes(li.stairs)
+                 + mem_usage::vector_bytes(li.transporters)
+                 + mem_usage::vector_bytes(li.stair_distances)
+                 + li.excludes.size() * (sizeof(travel_exclude)
+                                         + 4 * sizeof(void*));
+    }
+    return total;
+}
+
 void TravelCache::save(writer& outf) const
 {
     write_save_version(outf, save_version::current());
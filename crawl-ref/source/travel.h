@@ -432,6 +432,9 @@ public:
 
     void update_daction_counters(); // of the current level
 
+    // Roughly how much heap memory the cached levels hold.
+    size_t memory_used() const;
+
     unsigned int query_daction_counter(daction_type c);
     void clear_daction_counter(daction_type c);
 
@@ -8,6 +8,10 @@
 #include "wiz-fsim.h"
 
 #include <cerrno>
+#ifdef UNIX
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
 
 #include "beam.h"
 #include "bitary.h"
@@ -33,6 +37,7 @@
 #include "output.h"
 #include "player-equip.h"
 #include "player.h"
+#include "random.h"
 #include "ranged-attack.h"
 #include "skills.h"
 #include "species.h"
@@ -455,6 +460,128 @@ static void _do_one_fsim_round(monster &mon, fight_data &fd, bool defend)
     you.move_to(you_start_pos, MV_INTERNAL);
 }
 
+// The part of a fight_damage_stats that rounds add to.
+struct fsim_tally
+{
+    unsigned int cumulative_damage;
+    int time_taken;
+    int hits;
+    int max_dam;
+};
+
+static fsim_tally _tally(const fight_damage_stats &stats)
+{
+    return { stats.cumulative_damage, stats.time_taken, stats.hits,
+             stats.max_dam };
+}
+
+static void _add_tally(fight_damage_stats &stats, const fsim_tally &tally)
+{
+    stats.cumulative_damage += tally.cumulative_damage;
+    stats.time_taken += tally.time_taken;
+    stats.hits += tally.hits;
+    stats.max_dam = max(stats.max_dam, tally.max_dam);
+}
+
+// Run one shard's share of the rounds, with its own random stream so that
+// the result doesn't depend on how the shards were run.
+static void _do_fsim_shard(monster &mon, fight_data &fd, int rounds,
+                           uint64_t seed, int shard, bool defend)
+{
+    rng::subgenerator shard_rng(seed, shard);
+    for (int i = 0; i < rounds; i++)
+        _do_one_fsim_round(mon, fd, defend);
+}
+
+static int _fsim_shard_rounds(int iter_limit, int jobs, int shard)
+{
+    return iter_limit * (shard + 1) / jobs - iter_limit * shard / jobs;
+}
+
+// Split the rounds between fsim_jobs shards. Where possible, each shard runs
+// in a forked copy of the game, which has its own player and monster to
+// fight with, and reports its tallies back through a pipe. Returns the
+// number of rounds that were actually run.
+static int _do_fsim_rounds_sharded(monster &mon, fight_data &fdata,
+                                   int iter_limit, bool defend)
+{
+    const int jobs = min(Options.fsim_jobs, iter_limit);
+    const uint64_t seed = rng::get_uint64();
+    int completed = 0;
+
+#ifdef UNIX
+    vector<pair<pid_t, int>> workers;
+    for (int shard = 0; shard < jobs; shard++)
+    {
+        const int rounds = _fsim_shard_rounds(iter_limit, jobs, shard);
+        int fds[2] = { -1, -1 };
+        const pid_t pid = pipe(fds) ? -1 : fork();
+        if (pid == 0)
+        {
+            close(fds[0]);
+            fight_data part;
+            _do_fsim_shard(mon, part, rounds, seed, shard, defend);
+            const fsim_tally tallies[2] = { _tally(part.player),
+                                            _tally(part.monster) };
+            const bool ok = write(fds[1], tallies, sizeof(tallies))
+                            == (ssize_t) sizeof(tallies);
+            // Don't run any of the game's exit handlers in the copy.
+            _exit(ok ? 0 : 1);
+        }
+        else if (pid > 0)
+        {
+            close(fds[1]);
+            workers.emplace_back(pid, fds[0]);
+            continue;
+        }
+
+        // Couldn't fork; run this shard here instead.
+        if (pid < 0 && fds[0] >= 0)
+        {
+            close(fds[0]);
+            close(fds[1]);
+        }
+        workers.emplace_back(-1, shard);
+    }
+
+    for (int shard = 0; shard < jobs; shard++)
+    {
+        const int rounds = _fsim_shard_rounds(iter_limit, jobs, shard);
+        const pid_t pid = workers[shard].first;
+        if (pid < 0)
+        {
+            _do_fsim_shard(mon, fdata, rounds, seed, shard, defend);
+            completed += rounds;
+            continue;
+        }
+
+        const int fd = workers[shard].second;
+        fsim_tally tallies[2];
+        const bool ok = read(fd, tallies, sizeof(tallies))
+                        == (ssize_t) sizeof(tallies);
+        close(fd);
+        waitpid(pid, nullptr, 0);
+        if (!ok)
+        {
+            mprf(MSGCH_ERROR, "Fight simulator shard %d failed.", shard);
+            continue;
+        }
+        _add_tally(fdata.player, tallies[0]);
+        _add_tally(fdata.monster, tallies[1]);
+        completed += rounds;
+    }
+#else
+    for (int shard = 0; shard < jobs; shard++)
+    {
+        const int rounds = _fsim_shard_rounds(iter_limit, jobs, shard);
+        _do_fsim_shard(mon, fdata, rounds, seed, shard, defend);
+        completed += rounds;
+    }
+#endif
+
+    return completed;
+}
+
 static fight_data _get_fight_data(monster &mon, int iter_limit, bool defend)
 {
     const monster orig = mon;
@@ -479,8 +606,17 @@ static fight_data _get_fight_data(monster &mon, int iter_limit, bool defend)
     {
         msg::suppress mx;
 
-        for (int i = 0; i < iter_limit; i++)
-            _do_one_fsim_round(mon, fdata, defend);
+        if (Options.fsim_jobs > 1)
+        {
+            fdata.monster.iterations = fdata.player.iterations
+                = max(1, _do_fsim_rounds_sharded(mon, fdata, iter_limit,
+                                                 defend));
+        }
+        else
+        {
+            for (int i = 0; i < iter_limit; i++)
+                _do_one_fsim_round(mon, fdata, defend);
+        }
     }
 
     fdata.player.calc_output_stats();
@@ -23,11 +23,13 @@
 #include "items.h"
 #include "luaterp.h" // debug_terp_lua
 #include "macro.h"
+#include "mem-usage.h"
 #include "menu.h" // column_composer
 #include "message.h"
 #include "notes.h"
 #include "output.h"
 #include "player.h"
+#include "profiler.h"
 #include "prompt.h" // yes_or_no
 #include "religion.h" // religion_turn_end
 #include "skills.h"
@@ -124,11 +126,11 @@ static void _do_wizard_command(int wiz_command)
 
     case 'n': wizard_set_zot_clock(); break;
     case 'N': wizard_get_god_tension(); break;
-    // case CONTROL('N'): break;
+    case CONTROL('N'): mem_usage::wizard_memory_report(); break;
 
     case 'o': wizard_create_spec_object(); break;
     case 'O': debug_test_explore(); break;
-    // case CONTROL('O'): break;
+    case CONTROL('O'): profiler::wizard_profile(); break;
 
     case 'p': wizard_transform(); break;
     case 'P': debug_place_map(true); break;
@@ -527,6 +529,8 @@ int list_wizard_commands(bool do_redraw_screen)
                        "<w>Ctrl-F</w> double scale fsim\n"
                        "<w>Ctrl-I</w> item generation stats\n"
                        "<w>O</w>      measure exploration time\n"
+                       "<w>Ctrl-O</w> toggle/show turn profiler\n"
+                       "<w>Ctrl-N</w> show memory usage by subsystem\n"
                        "<w>Ctrl-T</w> dungeon (D)Lua interpreter\n"
                        "<w>Ctrl-U</w> client (C)Lua interpreter\n"
                        "<w>Ctrl-X</w> Xom effect stats\n"
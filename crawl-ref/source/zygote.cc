@@ -0,0 +1,255 @@
+/**
+ * @file
+ * @brief Preloaded fork-server launch mode for webtiles servers.
+ *
+ * Started with -zygote <socket>, crawl does all of its player-independent
+ * initialisation (dungeon Lua, the map cache, the database files, LOS rays)
+ * once and then waits for spawn requests on a Unix datagram socket. Each
+ * request is a JSON object
+ *
+ *     {"argv": ["crawl", "-name", "...", "-webtiles-socket", "...", ...],
+ *      "env": {"NAME": "value", ...}}
+ *
+ * sent together with one file descriptor (SCM_RIGHTS), the terminal the game
+ * should run on. The zygote forks; the child takes the descriptor as its
+ * stdin, stdout and stderr, applies the environment, reseeds its RNG, and
+ * then carries on with normal startup using the given arguments, reading
+ * the player's options as usual. The zygote replies to the sender with
+ * {"pid": <child pid>}, or {"error": "..."} if the request was unusable.
+ *
+ * The socket is only accessible to the user the zygote runs as, and "env"
+ * may only set the variables that the server sets for a game anyway.
+**/
+
+#include "AppHdr.h"
+
+#ifdef USE_TILE_WEB
+
+#include "zygote.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "end.h"
+#include "json-wrapper.h"
+#include "random.h"
+#include "startup.h"
+#include "stringutil.h"
+
+namespace zygote
+{
+    string socket_path;
+
+    // The terminal settings that the server always passes, and the ones that
+    // a game's "env" is documented for: its locale and crawl's own variables.
+    static const set<string> allowed_env =
+    {
+        "COLUMNS", "LINES", "TERM",
+        "LANG", "LC_ALL", "LC_CTYPE", "LC_MESSAGES",
+        "CRAWL_DIR", "CRAWL_NAME", "CRAWL_RC", "HOME",
+    };
+
+    struct spawn_request
+    {
+        vector<string> args;
+        vector<pair<string, string>> env;
+    };
+
+    static bool _parse_request(const string &data, spawn_request &req,
+                               string &error)
+    {
+        try
+        {
+            JsonWrapper obj = json_decode(data.c_str());
+            obj.check(JSON_OBJECT);
+
+            JsonWrapper argv = json_find_member(obj.node, "argv");
+            argv.check(JSON_ARRAY);
+            JsonNode *arg;
+            json_foreach(arg, argv.node)
+            {
+                if (arg->tag != JSON_STRING)
+                    throw JsonWrapper::malformed;
+                req.args.emplace_back(arg->string_);
+            }
+
+            JsonWrapper env = json_find_member(obj.node, "env");
+            if (env.node)
+            {
+                env.check(JSON_OBJECT);
+                JsonNode *var;
+                json_foreach(var, env.node)
+                {
+                    if (var->tag != JSON_STRING)
+                        throw JsonWrapper::malformed;
+                    if (!allowed_env.count(var->key))
+                    {
+                        error = make_stringf("environment variable %s not "
+                                             "allowed", var->key);
+                        return false;
+                    }
+                    req.env.emplace_back(var->key, var->string_);
+                }
+            }
+        }
+        catch (JsonWrapper::MalformedException&)
+        {
+            error = "malformed spawn request";
+            return false;
+        }
+
+        if (req.args.empty())
+        {
+            error = "empty argv";
+            return false;
+        }
+        return true;
+    }
+
+    // Receive one request and the descriptor passed with it (or -1).
+    static string _receive(int sock, sockaddr_un &src, socklen_t &src_len,
+                           int &fd)
+    {
+        char buf[16384];
+        char control[CMSG_SPACE(sizeof(int))];
+        iovec iov = { buf, sizeof(buf) };
+
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        memset(&src, 0, sizeof(src));
+        msg.msg_name = &src;
+        msg.msg_namelen = sizeof(src);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        fd = -1;
+        ssize_t len = recvmsg(sock, &msg, 0);
+        if (len == -1)
+        {
+            if (errno == EINTR)
+                return "";
+            die("Zygote socket read error: %s", strerror(errno));
+        }
+        src_len = msg.msg_namelen;
+
+        for (cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c))
+        {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS)
+                memcpy(&fd, CMSG_DATA(c), sizeof(int));
+        }
+        return string(buf, len);
+    }
+
+    static void _reply(int sock, const sockaddr_un &dest, socklen_t dest_len,
+                       JsonNode *reply)
+    {
+        JsonWrapper wrapper(reply);
+        if (!dest_len)
+            return;
+        const string msg = wrapper.to_string();
+        // The server may have gone away; there's no one to tell if so.
+        (void) sendto(sock, msg.c_str(), msg.size(), 0,
+                      (const sockaddr *) &dest, dest_len);
+    }
+
+    // Become the game process for a request. Runs in the forked child.
+    static void _become_child(int sock, int fd, const spawn_request &req)
+    {
+        close(sock);
+        signal(SIGCHLD, SIG_DFL);
+
+        setsid();
+        dup2(fd, STDIN_FILENO);
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        if (fd > STDERR_FILENO)
+            close(fd);
+        // Take the terminal as our controlling tty, so that hangups reach us.
+        ioctl(STDIN_FILENO, TIOCSCTTY, 0);
+
+        for (const auto &var : req.env)
+            setenv(var.first.c_str(), var.second.c_str(), 1);
+
+        // Don't share the zygote's random state with every other child.
+        rng::seed();
+    }
+
+    void serve(vector<string> &args)
+    {
+        preload_game_data();
+
+        int sock = socket(PF_UNIX, SOCK_DGRAM, 0);
+        if (sock < 0)
+            die("Can't open the zygote socket!");
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (socket_path.size() >= sizeof(addr.sun_path))
+            die("Zygote socket path is too long!");
+        strcpy(addr.sun_path, socket_path.c_str());
+        // Anyone who can write to the socket can start a game as us.
+        const mode_t old_umask = umask(S_IRWXG | S_IRWXO);
+        const bool bound = !::bind(sock, (sockaddr*) &addr,
+                                   sizeof(sockaddr_un));
+        umask(old_umask);
+        if (!bound)
+            die("Can't bind the zygote socket!");
+
+        // Children are the server's business; don't leave zombies around.
+        signal(SIGCHLD, SIG_IGN);
+
+        while (true)
+        {
+            sockaddr_un src;
+            socklen_t src_len = 0;
+            int fd;
+            const string data = _receive(sock, src, src_len, fd);
+            if (data.empty())
+            {
+                if (fd >= 0)
+                    close(fd);
+                continue;
+            }
+
+            JsonNode *reply = json_mkobject();
+            spawn_request req;
+            string error;
+            if (fd < 0)
+                error = "no terminal descriptor";
+            else if (_parse_request(data, req, error))
+            {
+                const pid_t pid = fork();
+                if (pid == 0)
+                {
+                    json_delete(reply);
+                    _become_child(sock, fd, req);
+                    args = req.args;
+                    return;
+                }
+                if (pid < 0)
+                    error = make_stringf("fork failed: %s", strerror(errno));
+                else
+                    json_append_member(reply, "pid", json_mknumber(pid));
+            }
+
+            if (fd >= 0)
+                close(fd);
+            if (!error.empty())
+                json_append_member(reply, "error", json_mkstring(error));
+            _reply(sock, src, src_len, reply);
+        }
+    }
+}
+
+#endif
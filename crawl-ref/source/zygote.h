@@ -0,0 +1,28 @@
+/**
+ * @file
+ * @brief Preloaded fork-server launch mode for webtiles servers.
+**/
+
+#pragma once
+
+#ifdef USE_TILE_WEB
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace zygote
+{
+    // Set by the -zygote command line option.
+    extern string socket_path;
+
+    // Load everything that doesn't depend on the player, then wait on
+    // socket_path for spawn requests, forking a child for each one. Only
+    // returns in a child, with `args` set to the command line that the
+    // child's game should run with.
+    void serve(vector<string> &args);
+}
+
+#endif